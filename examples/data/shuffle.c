@@ -26,18 +26,18 @@ int main(void)
         x, y,
         val_percentage, test_percentage, shuffle);
     
-    train_data_x->print(train_data_x);
-    val_data_x->print(val_data_x);
-    test_data_x->print(test_data_x);
-
-    train_data_x->free(&train_data_x);
-    train_data_y->free(&train_data_y);
-    val_data_x->free(&val_data_x);
-    val_data_y->free(&val_data_y);
-    test_data_x->free(&test_data_x);
-    test_data_y->free(&test_data_y);
-    x->free(&x);
-    y->free(&y);
+    train_data_x->vt->print(train_data_x);
+    val_data_x->vt->print(val_data_x);
+    test_data_x->vt->print(test_data_x);
+
+    train_data_x->vt->free(&train_data_x);
+    train_data_y->vt->free(&train_data_y);
+    val_data_x->vt->free(&val_data_x);
+    val_data_y->vt->free(&val_data_y);
+    test_data_x->vt->free(&test_data_x);
+    test_data_y->vt->free(&test_data_y);
+    x->vt->free(&x);
+    y->vt->free(&y);
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
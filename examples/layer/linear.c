@@ -16,16 +16,16 @@ int main(void)
 
     cml_matrix *x = cml_matrix_alloc(4, n_inputs);
     matrix_random_fill(&x, 10);
-    x->print(x);
+    x->vt->print(x);
 
     cml_matrix *y = layer->eval(layer, x);
     if (y != NULL)
     {
-        y->print(y);
-        y->free(&y);
+        y->vt->print(y);
+        y->vt->free(&y);
     }
 
-    x->free(&x);
+    x->vt->free(&x);
     layer->free(&layer);
     prng->free(&prng);
 
@@ -8,8 +8,8 @@ int main(void)
 
     cml_matrix *a = cml_matrix_alloc(3, 4);
     matrix_random_fill(&a, 10);
-    a->print(a);
+    a->vt->print(a);
 
-    a->free(&a);
+    a->vt->free(&a);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "cml_batch.h"
+#include "matrix_header.h"
+
+#include <stdio.h>
+#include <time.h>
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1E-09 * t.tv_nsec;
+}
+
+// the matrix b of the stack A of (n, n) matrices
+static cml_matrix *unstack(cml_matrix *a, const lgint b, const lgint n)
+{
+    cml_matrix *x = cml_matrix_alloc(n, n);
+    for (lgint t = 0; t < n * n; t++)
+    {
+        x->vt->set(&x, t / n, t % n, a->vt->get(a, b, t));
+    }
+    return x;
+}
+
+int main(void)
+{
+    srand(time(NULL));
+
+    // count systems of 3 equations A*x = y
+    const lgint count = 200000, n = 3;
+    cml_matrix *a = cml_matrix_alloc(count, n * n);
+    cml_matrix *y = cml_matrix_alloc(count, n);
+    matrix_random_fill(&a, 100);
+    matrix_random_fill(&y, 100);
+    for (lgint b = 0; b < count; b++)
+    {
+        // diagonally dominant, hence regular
+        for (lgint i = 0; i < n; i++)
+        {
+            a->vt->set(&a, b, i * (n + 1), a->vt->get(a, b, i * (n + 1)) + 200.);
+        }
+    }
+    cml_matrix *x = cml_matrix_alloc(count, n);
+    cml_matrix *det = cml_matrix_alloc(count, 1);
+
+    double t = now();
+    cml_batch_solve(n, 1, a, y, x);
+    cml_batch_det(n, a, det);
+    t = now() - t;
+    printf("%ld systems (%ld, %ld) solved in %.4f s\n", count, n, n, t);
+
+    printf("==== first system, batched ====\n");
+    printf("det = %g\n", det->vt->get(det, 0, 0));
+    for (lgint i = 0; i < n; i++)
+    {
+        printf("x[%ld] = %g\n", i, x->vt->get(x, 0, i));
+    }
+
+    printf("==== first system, one matrix ====\n");
+    cml_matrix *a0 = unstack(a, 0, n);
+    cml_matrix *y0 = cml_matrix_alloc(n, 1);
+    for (lgint i = 0; i < n; i++)
+    {
+        y0->vt->set(&y0, i, 0, y->vt->get(y, 0, i));
+    }
+    printf("det = %g\n", a0->vt->det(a0));
+    cml_matrix *x0 = cml_matrix_solve(a0, y0);
+    if (x0 != NULL)
+    {
+        x0->vt->print(x0);
+        x0->vt->free(&x0);
+    }
+
+    // [[1, 2, 3], [4, 5, 6], [7, 8, 9]] is singular: its last pivot is a rounding error, not a zero
+    printf("==== singular system, batched ====\n");
+    cml_matrix *s = cml_matrix_alloc(1, n * n);
+    cml_matrix *sy = cml_matrix_alloc(1, n);
+    cml_matrix *sx = cml_matrix_alloc(1, n);
+    cml_matrix *sinv = cml_matrix_alloc(1, n * n);
+    cml_matrix *sdet = cml_matrix_alloc(1, 1);
+    for (lgint t = 0; t < n * n; t++)
+    {
+        s->vt->set(&s, 0, t, t + 1);
+    }
+    for (lgint i = 0; i < n; i++)
+    {
+        sy->vt->set(&sy, 0, i, 1.);
+    }
+    cml_batch_det(n, s, sdet);
+    cml_batch_inv(n, s, sinv);
+    cml_batch_solve(n, 1, s, sy, sx);
+    printf("det = %g (expected 0)\n", sdet->vt->get(sdet, 0, 0));
+    printf("inv[0] = %g, x[0] = %g (expected nan)\n", sinv->vt->get(sinv, 0, 0), sx->vt->get(sx, 0, 0));
+    cml_matrix *s32 = cml_matrix_cast(s, FLOAT32);
+    cml_matrix *sdet32 = cml_matrix_alloc_dtype(1, 1, FLOAT32);
+    cml_batch_det(n, s32, sdet32);
+    printf("det in single precision = %g (expected 0)\n", sdet32->vt->get(sdet32, 0, 0));
+
+    t = now();
+    fdouble sum = 0.;
+    for (lgint b = 0; b < count; b++)
+    {
+        cml_matrix *ab = unstack(a, b, n);
+        sum += ab->vt->det(ab);
+        ab->vt->free(&ab);
+    }
+    t = now() - t;
+    printf("the same determinants one matrix at a time in %.4f s (sum %g)\n", t, sum);
+
+    a->vt->free(&a);
+    y->vt->free(&y);
+    x->vt->free(&x);
+    det->vt->free(&det);
+    a0->vt->free(&a0);
+    y0->vt->free(&y0);
+    s->vt->free(&s);
+    sy->vt->free(&sy);
+    sx->vt->free(&sx);
+    sinv->vt->free(&sinv);
+    sdet->vt->free(&sdet);
+    s32->vt->free(&s32);
+    sdet32->vt->free(&sdet32);
+    return EXIT_SUCCESS;
+}
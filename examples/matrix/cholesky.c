@@ -0,0 +1,48 @@
+#include "matrix_header.h"
+
+#include <stdio.h>
+#include <time.h>
+
+int main(void)
+{
+    srand(time(NULL));
+
+    // X^T*X + I is symmetric positive definite
+    cml_matrix *x = cml_matrix_alloc(5, 3);
+    matrix_random_fill(&x, 5);
+    cml_matrix *a = cml_matrix_syrk(x);
+    for (lgint i = 0; i < a->m; i++)
+    {
+        a->vt->set(&a, i, i, a->vt->get(a, i, i) + 1.);
+    }
+    a->vt->print(a);
+
+    cml_matrix *l = cml_matrix_cholesky(a);
+    if (l != NULL)
+    {
+        l->vt->print(l);
+
+        printf("==== check L*L^T = A ====\n");
+        cml_matrix *llt = cml_matrix_prod_nt(l, l);
+        llt->vt->print(llt);
+        llt->vt->free(&llt);
+        l->vt->free(&l);
+    }
+
+    cml_matrix *b = cml_matrix_alloc(3, 1);
+    matrix_random_fill(&b, 5);
+    b->vt->print(b);
+
+    printf("==== solution of Ax=b =====\n");
+    cml_matrix *w = cml_matrix_solve_spd(a, b);
+    if (w != NULL)
+    {
+        w->vt->print(w);
+        w->vt->free(&w);
+    }
+
+    x->vt->free(&x);
+    a->vt->free(&a);
+    b->vt->free(&b);
+    return EXIT_SUCCESS;
+}
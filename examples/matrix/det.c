@@ -9,10 +9,10 @@ int main(void)
 
     cml_matrix *a = cml_matrix_alloc(3, 3);
     matrix_random_fill(&a, 10);
-    a->print(a);
+    a->vt->print(a);
 
-    printf("det = %lg\n", a->det(a));
+    printf("det = %lg\n", a->vt->det(a));
 
-    a->free(&a);
+    a->vt->free(&a);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
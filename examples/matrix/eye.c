@@ -3,8 +3,8 @@
 int main(void)
 {
     cml_matrix *a = cml_matrix_eye(3);
-    a->print(a);
+    a->vt->print(a);
 
-    a->free(&a);
+    a->vt->free(&a);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
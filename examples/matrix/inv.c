@@ -9,28 +9,28 @@ int main(void)
 
     cml_matrix *a = cml_matrix_alloc(4, 4);
     matrix_random_fill(&a, 5);
-    a->print(a);
+    a->vt->print(a);
 
     printf("==== inverse ====\n");
 
-    cml_matrix *ainv = a->inv(a);
+    cml_matrix *ainv = a->vt->inv(a);
     if(ainv != NULL)
     {
-        ainv->print(ainv);
+        ainv->vt->print(ainv);
 
         printf("==== A*A^-1 ====\n");
         cml_matrix *eye = cml_matrix_prod(a, ainv);
-        eye->print(eye);
-        eye->free(&eye);
+        eye->vt->print(eye);
+        eye->vt->free(&eye);
 
         printf("==== A^-1*A ====\n");
         eye = cml_matrix_prod(ainv, a);
-        eye->print(eye);
-        eye->free(&eye);
+        eye->vt->print(eye);
+        eye->vt->free(&eye);
 
-        ainv->free(&ainv);
+        ainv->vt->free(&ainv);
     }
 
-    a->free(&a);
+    a->vt->free(&a);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "matrix_header.h"
+
+#include <stdio.h>
+#include <time.h>
+
+int main(void)
+{
+    srand(time(NULL));
+
+    // y = 2*x + 1 with noise, fitted on the columns [1, x]
+    const lgint m = 20;
+    cml_matrix *a = cml_matrix_alloc(m, 2);
+    cml_matrix *y = cml_matrix_alloc(m, 1);
+    for (lgint i = 0; i < m; i++)
+    {
+        const fdouble x = (fdouble)i / m;
+        a->vt->set(&a, i, 0, 1.);
+        a->vt->set(&a, i, 1, x);
+        y->vt->set(&y, i, 0, 2. * x + 1. + 0.01 * (rand() % 11 - 5));
+    }
+
+    cml_matrix *q = NULL, *r = NULL;
+    cml_matrix_qr(a, &q, &r);
+    if (q != NULL && r != NULL)
+    {
+        r->vt->print(r);
+
+        printf("==== check Q^T*Q = I ====\n");
+        cml_matrix *qtq = cml_matrix_prod_tn(q, q);
+        qtq->vt->print(qtq);
+        qtq->vt->free(&qtq);
+        q->vt->free(&q);
+        r->vt->free(&r);
+    }
+
+    printf("==== least-squares solution of Ax=y ====\n");
+    cml_matrix *w = cml_matrix_lstsq(a, y);
+    if (w != NULL)
+    {
+        w->vt->print(w);
+        w->vt->free(&w);
+    }
+
+    a->vt->free(&a);
+    y->vt->free(&y);
+    return EXIT_SUCCESS;
+}
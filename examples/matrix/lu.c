@@ -9,29 +9,29 @@ int main(void)
 
     cml_matrix *a = cml_matrix_alloc(3, 3);
     matrix_random_fill(&a, 10);
-    a->print(a);
+    a->vt->print(a);
 
     cml_matrix *p = NULL, *l = NULL, *u = NULL;
-    a->lu(a, &p, &l, &u);
+    a->vt->lu(a, &p, &l, &u);
     if(p != NULL && l != NULL && u != NULL)
     {
-        p->print(p);
-        l->print(l);
-        u->print(u);
+        p->vt->print(p);
+        l->vt->print(l);
+        u->vt->print(u);
 
         printf("==== check LU = PA ====\n");
         cml_matrix *lu = cml_matrix_prod(l, u);
         cml_matrix *pa = cml_matrix_prod(p, a);
-        lu->print(lu);
-        pa->print(pa);
-        lu->free(&lu);
-        pa->free(&pa);
+        lu->vt->print(lu);
+        pa->vt->print(pa);
+        lu->vt->free(&lu);
+        pa->vt->free(&pa);
 
-        p->free(&p);
-        l->free(&l);
-        u->free(&u);
+        p->vt->free(&p);
+        l->vt->free(&l);
+        u->vt->free(&u);
     }
 
-    a->free(&a);
+    a->vt->free(&a);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
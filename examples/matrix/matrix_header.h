@@ -11,7 +11,7 @@ void matrix_random_fill(cml_matrix **a, const lgint max)
     {
         for (lgint j = 0; j < (*a)->n; j++)
         {
-            (*a)->set(a, i, j, rand() % max);
+            (*a)->vt->set(a, i, j, rand() % max);
         }
     }
 }
\ No newline at end of file
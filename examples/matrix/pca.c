@@ -0,0 +1,85 @@
+#include "matrix_header.h"
+#include "cml_pca.h"
+
+#include <stdio.h>
+#include <time.h>
+
+int main(void)
+{
+    srand(time(NULL));
+
+    printf("==== eigendecomposition of a symmetric matrix ====\n");
+    cml_matrix *a = cml_matrix_alloc(3, 3);
+    const fdouble values[3][3] = {{4., 1., 2.}, {1., 3., 0.5}, {2., 0.5, 1.}};
+    for (lgint i = 0; i < 3; i++)
+    {
+        for (lgint j = 0; j < 3; j++)
+        {
+            a->vt->set(&a, i, j, values[i][j]);
+        }
+    }
+    cml_matrix *w = NULL, *v = NULL;
+    cml_matrix_eigh(a, &w, &v);
+    if (w != NULL && v != NULL)
+    {
+        w->vt->print(w);
+        v->vt->print(v);
+        w->vt->free(&w);
+        v->vt->free(&v);
+    }
+    a->vt->free(&a);
+
+    // 6 features driven by 2 hidden factors with noise
+    const lgint m = 200, n = 6;
+    cml_matrix *x = cml_matrix_alloc(m, n);
+    for (lgint i = 0; i < m; i++)
+    {
+        const fdouble f1 = rand() % 100 / 10., f2 = rand() % 100 / 10.;
+        for (lgint j = 0; j < n; j++)
+        {
+            x->vt->set(&x, i, j, (j + 1) * f1 - (j % 3) * f2 + 0.01 * (rand() % 11 - 5));
+        }
+    }
+
+    printf("==== explained variance ratio of 2 components ====\n");
+    cml_pca *pca = cml_pca_create(2);
+    pca->fit(pca, x);
+    if (pca->n != 0)
+    {
+        pca->explained_variance_ratio->vt->print(pca->explained_variance_ratio);
+
+        cml_matrix *z = pca->transform(pca, x);
+        cml_matrix *back = pca->inverse_transform(pca, z);
+        cml_matrix *error = cml_matrix_dif(back, x);
+        printf("==== reconstruction error of the first rows ====\n");
+        cml_matrix *head = cml_matrix_view_rows(error, 0, 3);
+        head->vt->print(head);
+        head->vt->free(&head);
+        z->vt->free(&z);
+        back->vt->free(&back);
+        error->vt->free(&error);
+    }
+    pca->free(&pca);
+    x->vt->free(&x);
+
+    // wide data, more features than rows: 1000 features driven by 3 hidden factors
+    const lgint mw = 200, nw = 1000;
+    cml_matrix *xw = cml_matrix_alloc(mw, nw);
+    for (lgint i = 0; i < mw; i++)
+    {
+        const fdouble f1 = rand() % 100 / 10., f2 = rand() % 100 / 10., f3 = rand() % 100 / 10.;
+        for (lgint j = 0; j < nw; j++)
+        {
+            xw->vt->set(&xw, i, j, (j % 7) * f1 - (j % 5) * f2 + (j % 3) * f3 + 0.01 * (rand() % 11 - 5));
+        }
+    }
+
+    printf("==== explained variance ratio of 3 components, (%ld, %ld) data ====\n", mw, nw);
+    cml_pca *wide = cml_pca_create(3);
+    wide->fit(wide, xw);
+    if (wide->n != 0)
+        wide->explained_variance_ratio->vt->print(wide->explained_variance_ratio);
+    wide->free(&wide);
+    xw->vt->free(&xw);
+    return EXIT_SUCCESS;
+}
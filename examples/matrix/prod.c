@@ -9,23 +9,23 @@ int main(void)
 
     cml_matrix *a = cml_matrix_alloc(3, 4);
     matrix_random_fill(&a, 5);
-    a->print(a);
+    a->vt->print(a);
 
     printf("*\n");
 
     cml_matrix *b = cml_matrix_alloc(4, 3);
     matrix_random_fill(&b, 5);
-    b->print(b);
+    b->vt->print(b);
 
     printf("==== product =====\n");
     cml_matrix *p = cml_matrix_prod(a, b);
     if (p != NULL)
     {
-        p->print(p);
-        p->free(&p);
+        p->vt->print(p);
+        p->vt->free(&p);
     }
 
-    a->free(&a);
-    b->free(&b);
+    a->vt->free(&a);
+    b->vt->free(&b);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "matrix_header.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+// print the reduction `op` of the rows of A, named `name`
+static void print_rows(const char *name, const cml_reduction op, cml_matrix *const a)
+{
+    printf("==== %s of the rows ====\n", name);
+    cml_matrix *r = cml_matrix_reduce_rows(op, a, cml_matrix_alloc(a->m, 1));
+    if (r != NULL)
+    {
+        r->vt->print(r);
+        r->vt->free(&r);
+    }
+}
+
+int main(void)
+{
+    srand(time(NULL));
+
+    cml_matrix *a = cml_matrix_alloc(3, 4);
+    matrix_random_fill(&a, 5);
+    a->vt->print(a);
+
+    print_rows("sum", REDUCE_SUM, a);
+    print_rows("max", REDUCE_MAX, a);
+    print_rows("argmax", REDUCE_ARGMAX, a);
+    print_rows("logsumexp", REDUCE_LOGSUMEXP, a);
+
+    printf("==== mean of the columns ====\n");
+    cml_matrix *mean = cml_matrix_reduce_columns(REDUCE_MEAN, a, cml_matrix_alloc(1, a->n));
+    if (mean != NULL)
+    {
+        mean->vt->print(mean);
+        mean->vt->free(&mean);
+    }
+
+    // logits with masked entries: a fully masked row or column stays -inf, one holding +inf is +inf
+    cml_matrix *logits = cml_matrix_alloc(3, 4);
+    for (lgint j = 0; j < logits->n; j++)
+    {
+        logits->vt->set(&logits, 0, j, (j % 2 == 0) ? -INFINITY : (fdouble)j);
+        logits->vt->set(&logits, 1, j, -INFINITY);
+        logits->vt->set(&logits, 2, j, (j == 1) ? INFINITY : (j == 2) ? -INFINITY : (fdouble)j);
+    }
+    logits->vt->print(logits);
+    print_rows("logsumexp", REDUCE_LOGSUMEXP, logits);
+
+    printf("==== logsumexp of the columns ====\n");
+    cml_matrix *lse = cml_matrix_reduce_columns(REDUCE_LOGSUMEXP, logits, cml_matrix_alloc(1, logits->n));
+    if (lse != NULL)
+    {
+        lse->vt->print(lse);
+        lse->vt->free(&lse);
+    }
+
+    a->vt->free(&a);
+    logits->vt->free(&logits);
+    return EXIT_SUCCESS;
+}
@@ -9,27 +9,27 @@ int main(void)
 
     cml_matrix *a = cml_matrix_alloc(3, 3);
     matrix_random_fill(&a, 5);
-    a->print(a);
+    a->vt->print(a);
 
     cml_matrix *b = cml_matrix_alloc(3, 1);
     matrix_random_fill(&b, 5);
-    b->print(b);
+    b->vt->print(b);
 
     printf("==== solution of Ax=b =====\n");
     cml_matrix *x = cml_matrix_solve(a, b);
     if (x != NULL)
     {
-        x->print(x);
+        x->vt->print(x);
 
         printf("==== compute A^-1*b ====\n");
         cml_matrix *bprime = cml_matrix_prod(a, x);
-        bprime->print(bprime);
-        bprime->free(&bprime);
+        bprime->vt->print(bprime);
+        bprime->vt->free(&bprime);
 
-        x->free(&x);
+        x->vt->free(&x);
     }
 
-    a->free(&a);
-    b->free(&b);
+    a->vt->free(&a);
+    b->vt->free(&b);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
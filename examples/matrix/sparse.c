@@ -0,0 +1,44 @@
+#include "matrix_header.h"
+#include "cml_sparse.h"
+
+#include <stdio.h>
+#include <time.h>
+
+int main(void)
+{
+    srand(time(NULL));
+
+    // one-hot rows: a single 1 per row
+    cml_matrix *a = cml_matrix_zeros(5, 8);
+    for (lgint i = 0; i < a->m; i++)
+    {
+        a->vt->set(&a, i, rand() % a->n, 1.);
+    }
+    cml_sparse *s = cml_sparse_from_dense(a);
+    s->print(s);
+
+    printf("*\n");
+
+    cml_matrix *b = cml_matrix_alloc(8, 3);
+    matrix_random_fill(&b, 5);
+    b->vt->print(b);
+
+    printf("==== sparse product =====\n");
+    cml_matrix *p = cml_matrix_alloc(5, 3);
+    if (cml_sparse_gemm(false, 1., s, b, 0., p) != NULL)
+        p->vt->print(p);
+
+    printf("==== dense product =====\n");
+    cml_matrix *d = cml_matrix_prod(a, b);
+    if (d != NULL)
+    {
+        d->vt->print(d);
+        d->vt->free(&d);
+    }
+
+    p->vt->free(&p);
+    s->free(&s);
+    a->vt->free(&a);
+    b->vt->free(&b);
+    return EXIT_SUCCESS;
+}
@@ -9,23 +9,23 @@ int main(void)
 
     cml_matrix *a = cml_matrix_alloc(3, 4);
     matrix_random_fill(&a, 5);
-    a->print(a);
+    a->vt->print(a);
 
     printf("+\n");
 
     cml_matrix *b = cml_matrix_alloc(3, 4);
     matrix_random_fill(&b, 5);
-    b->print(b);
+    b->vt->print(b);
 
     printf("==== sum =====\n");
     cml_matrix *s = cml_matrix_sum(a, b);
     if (s != NULL)
     {
-        s->print(s);
-        s->free(&s);
+        s->vt->print(s);
+        s->vt->free(&s);
     }
 
-    a->free(&a);
-    b->free(&b);
+    a->vt->free(&a);
+    b->vt->free(&b);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
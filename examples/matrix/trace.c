@@ -9,10 +9,10 @@ int main(void)
 
     cml_matrix *a = cml_matrix_alloc(4, 4);
     matrix_random_fill(&a, 10);
-    a->print(a);
+    a->vt->print(a);
 
-    printf("trace = %lg\n", a->trace(a));
+    printf("trace = %lg\n", a->vt->trace(a));
 
-    a->free(&a);
+    a->vt->free(&a);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
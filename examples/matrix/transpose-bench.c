@@ -0,0 +1,80 @@
+#include "matrix_header.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define REPEAT 5
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1E-09 * t.tv_nsec;
+}
+
+// best bandwidth in GB/s, counting one read and one write per element
+static double bandwidth(const lgint m, const lgint n, const double seconds)
+{
+    return 2. * m * n * sizeof(fdouble) / seconds * 1E-09;
+}
+
+// padded rows are allocated with cml_matrix_alloc_ld
+static void bench(const lgint m, const lgint n, const bool padded)
+{
+    cml_matrix *a = padded ? cml_matrix_alloc_ld(m, n, 0, FLOAT64) : cml_matrix_alloc(m, n);
+    matrix_random_fill(&a, 100);
+    cml_matrix *at = padded ? cml_matrix_alloc_ld(n, m, 0, FLOAT64) : cml_matrix_alloc(n, m);
+    fdouble *src = (fdouble *)malloc(m * n * sizeof(*src));
+    fdouble *dst = (fdouble *)malloc(m * n * sizeof(*dst));
+    memset(src, 0, m * n * sizeof(*src));
+    memset(dst, 0, m * n * sizeof(*dst));
+
+    double t_copy = 1E+09, t_transpose = 1E+09, t_inplace = 1E+09;
+    for (int r = 0; r < REPEAT; r++)
+    {
+        double t = now();
+        memcpy(dst, src, m * n * sizeof(*src));
+        t = now() - t;
+        t_copy = (t < t_copy) ? t : t_copy;
+
+        t = now();
+        a->vt->transpose(a, &at);
+        t = now() - t;
+        t_transpose = (t < t_transpose) ? t : t_transpose;
+
+        if (m == n)
+        {
+            t = now();
+            at->vt->transpose(at, &at);
+            t = now() - t;
+            t_inplace = (t < t_inplace) ? t : t_inplace;
+        }
+    }
+
+    printf("%6ld x %-6ld%s memcpy %6.2f GB/s   transpose %6.2f GB/s", m, n, padded ? " padded" : "       ", bandwidth(m, n, t_copy), bandwidth(m, n, t_transpose));
+    if (m == n)
+        printf("   in place %6.2f GB/s", bandwidth(m, n, t_inplace));
+    printf("\n");
+
+    free(src);
+    free(dst);
+    a->vt->free(&a);
+    at->vt->free(&at);
+}
+
+int main(void)
+{
+    srand(time(NULL));
+
+    bench(24000, 40, false);
+    bench(40, 24000, false);
+    bench(24000, 64, false);
+    bench(24000, 64, true);
+    bench(1000, 1000, false);
+    bench(4096, 4096, false);
+    bench(4096, 4096, true);
+    bench(5000, 3000, false);
+
+    return EXIT_SUCCESS;
+}
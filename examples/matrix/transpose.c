@@ -9,17 +9,17 @@ int main(void)
 
     cml_matrix *a = cml_matrix_alloc(3, 2);
     matrix_random_fill(&a, 10);
-    a->print(a);
+    a->vt->print(a);
 
     printf("==== tanspose =====\n");
     cml_matrix *at = NULL;
-    a->transpose(a, &at);
+    a->vt->transpose(a, &at);
     if (at != NULL)
     {
-        at->print(at);
-        at->free(&at);
+        at->vt->print(at);
+        at->vt->free(&at);
     }
 
-    a->free(&a);
+    a->vt->free(&a);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
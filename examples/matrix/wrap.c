@@ -0,0 +1,45 @@
+#include "matrix_header.h"
+
+#include <stdio.h>
+
+// release of the features, as a service would hand them back to its decoder
+static void release(void *data, void *ctx)
+{
+    printf("release of the block of %s\n", (const char *)ctx);
+    free(data);
+}
+
+int main(void)
+{
+    // 3 rows of 2 features in a caller array, used in place
+    fdouble x[3][2] = {{1., 2.}, {3., 4.}, {5., 6.}};
+    cml_matrix *a = cml_matrix_wrap(&x[0][0], 3, 2, 0, NULL, NULL);
+    cml_matrix *b = cml_matrix_alloc(2, 2);
+    matrix_random_fill(&b, 10);
+
+    printf("==== A wraps x ====\n");
+    a->vt->print(a);
+    cml_matrix *c = cml_matrix_prod(a, b);
+    c->vt->print(c);
+
+    printf("==== writes to A land in x ====\n");
+    a->vt->set(&a, 2, 1, -6.);
+    printf("x[2][1] = %g\n", x[2][1]);
+
+    // rows padded to 4 elements, freed by the deleter with the matrix
+    const lgint m = 4, n = 3, ld = 4;
+    fdouble *block = (fdouble *)malloc(m * ld * sizeof(*block));
+    for (lgint i = 0; i < m * ld; i++)
+    {
+        block[i] = (fdouble)i;
+    }
+    cml_matrix *d = cml_matrix_wrap(block, m, n, ld, &release, "features");
+    printf("==== D wraps a padded block ====\n");
+    d->vt->print(d);
+
+    a->vt->free(&a);
+    b->vt->free(&b);
+    c->vt->free(&c);
+    d->vt->free(&d);
+    return EXIT_SUCCESS;
+}
@@ -49,37 +49,37 @@ int main(void)
     const lgint epochs = 80000;
     model->fit(model, train_data_x, train_data_y, &learning_rate, alpha, epochs);
 
-    test_data_y->print(test_data_y);
+    test_data_y->vt->print(test_data_y);
     cml_matrix *yhat = model->predict(model, test_data_x);
     if(yhat)
     {
-        yhat->softmax(&yhat);
-        yhat->print(yhat);
+        yhat->vt->softmax(&yhat);
+        yhat->vt->print(yhat);
 
         cml_matrix *conf = cml_matrix_confusion(yhat, test_data_y);
-        conf->print(conf);
-        conf->free(&conf);
+        conf->vt->print(conf);
+        conf->vt->free(&conf);
 
         cml_matrix *prec = NULL, *accur = NULL, *f1_score = NULL;
         cml_class_metrics(&prec, &accur, &f1_score, yhat, test_data_y);
-        prec->print(prec);
-        accur->print(accur);
-        f1_score->print(f1_score);
-        prec->free(&prec);
-        accur->free(&accur);
-        f1_score->free(&f1_score);
+        prec->vt->print(prec);
+        accur->vt->print(accur);
+        f1_score->vt->print(f1_score);
+        prec->vt->free(&prec);
+        accur->vt->free(&accur);
+        f1_score->vt->free(&f1_score);
 
-        yhat->free(&yhat);
+        yhat->vt->free(&yhat);
     }
 
-    train_data_x->free(&train_data_x);
-    train_data_y->free(&train_data_y);
-    val_data_x->free(&val_data_x);
-    val_data_y->free(&val_data_y);
-    test_data_x->free(&test_data_x);
-    test_data_y->free(&test_data_y);
-    x->free(&x);
-    y->free(&y);
+    train_data_x->vt->free(&train_data_x);
+    train_data_y->vt->free(&train_data_y);
+    val_data_x->vt->free(&val_data_x);
+    val_data_y->vt->free(&val_data_y);
+    test_data_x->vt->free(&test_data_x);
+    test_data_y->vt->free(&test_data_y);
+    x->vt->free(&x);
+    y->vt->free(&y);
 
     model->free(&model);
     prng->free(&prng);
@@ -1,6 +1,7 @@
 #include "cml_data.h"
 #include "cml_sequential.h"
 #include "cml_prng.h"
+#include "cml_scaler.h"
 
 #include <stdbool.h>
 #include <stdio.h>
@@ -23,14 +24,19 @@ int main(void)
     const char *delimiter = ",";
     bool has_header = false;
     cml_data_read(&x_train, &y_train, file_path, delimiter, has_header);
-    cml_matrix *x_train_normalized = x_train->normalize(x_train);
+
+    // the scaling is fitted on the train data only, and applied as is to the test data
+    cml_scaler *scaler = cml_scaler_create(MIN_MAX_SCALING);
+    scaler->fit(scaler, x_train);
+    cml_matrix *x_train_normalized = scaler->transform(scaler, x_train->vt->copy(x_train));
 
     // get test data
     cml_matrix *x_test = cml_matrix_zeros(360, 40);
     cml_matrix *y_test = cml_matrix_zeros(360, 1);
     file_path = "data/lattice-physics+(pwr+fuel+assembly+neutronics+simulation+results)/test.data";
     cml_data_read(&x_test, &y_test, file_path, delimiter, has_header);
-    cml_matrix *x_test_normalized = x_train->normalize(x_test);
+    cml_matrix *x_test_normalized = scaler->transform(scaler, x_test->vt->copy(x_test));
+    scaler->free(&scaler);
 
     cml_layer *layers[] = {
         cml_layer_create(64, LEAKY_RELU),
@@ -71,15 +77,15 @@ int main(void)
         printf("Median Absolute Error(MAE)                      : %lg\n", medae);
         printf("-------------------------------------------------------------------\n");
 
-        yhat->free(&yhat);
+        yhat->vt->free(&yhat);
     }
 
-    x_train->free(&x_train);
-    y_train->free(&y_train);
-    x_test->free(&x_test);
-    y_test->free(&y_test);
-    x_train_normalized->free(&x_train_normalized);
-    x_test_normalized->free(&x_test_normalized);
+    x_train->vt->free(&x_train);
+    y_train->vt->free(&y_train);
+    x_test->vt->free(&x_test);
+    y_test->vt->free(&y_test);
+    x_train_normalized->vt->free(&x_train_normalized);
+    x_test_normalized->vt->free(&x_test_normalized);
 
     model->free(&model);
     prng->free(&prng);
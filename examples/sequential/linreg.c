@@ -34,8 +34,8 @@ int main(void)
         {
             const fdouble xij = prng->normal(prng, 7, 10);
             const fdouble yij = f(xij);
-            x->set(&x, i, j, xij);
-            y->set(&y, i, j, yij);
+            x->vt->set(&x, i, j, xij);
+            y->vt->set(&y, i, j, yij);
         }
     }
 
@@ -90,17 +90,17 @@ int main(void)
         printf("Median Absolute Error(MAE)                      : %lg\n", medae);
         printf("-------------------------------------------------------------------\n");
 
-        yhat->free(&yhat);
+        yhat->vt->free(&yhat);
     }
 
-    train_data_x->free(&train_data_x);
-    train_data_y->free(&train_data_y);
-    val_data_x->free(&val_data_x);
-    val_data_y->free(&val_data_y);
-    test_data_x->free(&test_data_x);
-    test_data_y->free(&test_data_y);
-    x->free(&x);
-    y->free(&y);
+    train_data_x->vt->free(&train_data_x);
+    train_data_y->vt->free(&train_data_y);
+    val_data_x->vt->free(&val_data_x);
+    val_data_y->vt->free(&val_data_y);
+    test_data_x->vt->free(&test_data_x);
+    test_data_y->vt->free(&test_data_y);
+    x->vt->free(&x);
+    y->vt->free(&y);
 
     model->free(&model);
     prng->free(&prng);
@@ -18,18 +18,18 @@ static void set_data(cml_matrix **x, cml_matrix **y)
     for (lgint i = 0; i < (*x)->m; i++)
     {
         const fdouble xi = prng->normal(prng, 0, 1);
-        (*x)->set(x, i, 0, pow(xi, 3));
-        (*x)->set(x, i, 1, -6 * pow(xi, 2));
-        (*x)->set(x, i, 2, 3 * xi);
-        (*x)->set(x, i, 3, 7 + err);
+        (*x)->vt->set(x, i, 0, pow(xi, 3));
+        (*x)->vt->set(x, i, 1, -6 * pow(xi, 2));
+        (*x)->vt->set(x, i, 2, 3 * xi);
+        (*x)->vt->set(x, i, 3, 7 + err);
 
         fdouble yi = 0;
         for (lgint j = 0; j < (*x)->n; j++)
         {
-            yi += (*x)->get(*x, i, j);
+            yi += (*x)->vt->get(*x, i, j);
         }
 
-        (*y)->set(y, i, 0, yi);
+        (*y)->vt->set(y, i, 0, yi);
     }
 }
 
@@ -97,17 +97,17 @@ int main(void)
         printf("Median Absolute Error(MAE)                      : %lg\n", medae);
         printf("-------------------------------------------------------------------\n");
 
-        yhat->free(&yhat);
+        yhat->vt->free(&yhat);
     }
 
-    train_data_x->free(&train_data_x);
-    train_data_y->free(&train_data_y);
-    val_data_x->free(&val_data_x);
-    val_data_y->free(&val_data_y);
-    test_data_x->free(&test_data_x);
-    test_data_y->free(&test_data_y);
-    x->free(&x);
-    y->free(&y);
+    train_data_x->vt->free(&train_data_x);
+    train_data_y->vt->free(&train_data_y);
+    val_data_x->vt->free(&val_data_x);
+    val_data_y->vt->free(&val_data_y);
+    test_data_x->vt->free(&test_data_x);
+    test_data_y->vt->free(&test_data_y);
+    x->vt->free(&x);
+    y->vt->free(&y);
 
     model->free(&model);
     prng->free(&prng);
@@ -23,7 +23,7 @@ int main(void)
     bool has_header = true;
     cml_data_read(&x, &y, file_path, delimiter, has_header);
     // normalize the data
-    cml_matrix *x_normalized = x->normalize(x);
+    cml_matrix *x_normalized = x->vt->normalize(x);
 
     // split data into train, validation & test
     cml_matrix *train_data_x = NULL, *train_data_y = NULL;
@@ -55,63 +55,63 @@ int main(void)
     cml_matrix *yhat = model->predict(model, val_data_x);
     if(yhat)
     {
-        yhat->softmax(&yhat);
+        yhat->vt->softmax(&yhat);
 
         printf("Confusion matrix=");
         cml_matrix *conf = cml_matrix_confusion(yhat, val_data_y);
-        conf->print(conf);
-        conf->free(&conf);
+        conf->vt->print(conf);
+        conf->vt->free(&conf);
 
         cml_matrix *prec = NULL, *accur = NULL, *f1_score = NULL;
         cml_class_metrics(&prec, &accur, &f1_score, yhat, val_data_y);
         printf("Precision matrix=");
-        prec->print(prec);
+        prec->vt->print(prec);
         printf("Accuracy matrix=");
-        accur->print(accur);
+        accur->vt->print(accur);
         printf("F1 score matrix=");
-        f1_score->print(f1_score);
-        prec->free(&prec);
-        accur->free(&accur);
-        f1_score->free(&f1_score);
+        f1_score->vt->print(f1_score);
+        prec->vt->free(&prec);
+        accur->vt->free(&accur);
+        f1_score->vt->free(&f1_score);
 
-        yhat->free(&yhat);
+        yhat->vt->free(&yhat);
     }
 
     printf("Metrics\n");
     yhat = model->predict(model, test_data_x);
     if(yhat)
     {
-        yhat->softmax(&yhat);
+        yhat->vt->softmax(&yhat);
 
         printf("Confusion matrix=");
         cml_matrix *conf = cml_matrix_confusion(yhat, test_data_y);
-        conf->print(conf);
-        conf->free(&conf);
+        conf->vt->print(conf);
+        conf->vt->free(&conf);
 
         cml_matrix *prec = NULL, *accur = NULL, *f1_score = NULL;
         cml_class_metrics(&prec, &accur, &f1_score, yhat, test_data_y);
         printf("Precision matrix=");
-        prec->print(prec);
+        prec->vt->print(prec);
         printf("Accuracy matrix=");
-        accur->print(accur);
+        accur->vt->print(accur);
         printf("F1 score matrix=");
-        f1_score->print(f1_score);
-        prec->free(&prec);
-        accur->free(&accur);
-        f1_score->free(&f1_score);
+        f1_score->vt->print(f1_score);
+        prec->vt->free(&prec);
+        accur->vt->free(&accur);
+        f1_score->vt->free(&f1_score);
 
-        yhat->free(&yhat);
+        yhat->vt->free(&yhat);
     }
 
-    train_data_x->free(&train_data_x);
-    train_data_y->free(&train_data_y);
-    val_data_x->free(&val_data_x);
-    val_data_y->free(&val_data_y);
-    test_data_x->free(&test_data_x);
-    test_data_y->free(&test_data_y);
-    x->free(&x);
-    y->free(&y);
-    x_normalized->free(&x_normalized);
+    train_data_x->vt->free(&train_data_x);
+    train_data_y->vt->free(&train_data_y);
+    val_data_x->vt->free(&val_data_x);
+    val_data_y->vt->free(&val_data_y);
+    test_data_x->vt->free(&test_data_x);
+    test_data_y->vt->free(&test_data_y);
+    x->vt->free(&x);
+    y->vt->free(&y);
+    x_normalized->vt->free(&x_normalized);
 
     model->free(&model);
     prng->free(&prng);
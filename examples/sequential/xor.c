@@ -12,25 +12,11 @@ int main(void)
 {
     cml_prng *prng = cml_prng_init(NULL);
 
-    cml_matrix *x = cml_matrix_alloc(4, 2);
-    x->set(&x, 0, 0, 0);
-    x->set(&x, 0, 1, 0);
-    x->set(&x, 1, 0, 0);
-    x->set(&x, 1, 1, 1);
-    x->set(&x, 2, 0, 1);
-    x->set(&x, 2, 1, 0);
-    x->set(&x, 3, 0, 1);
-    x->set(&x, 3, 1, 1);
-
-    cml_matrix *y = cml_matrix_alloc(4, 2);
-    y->set(&y, 0, 0, 1);
-    y->set(&y, 0, 1, 0);
-    y->set(&y, 1, 0, 0);
-    y->set(&y, 1, 1, 1);
-    y->set(&y, 2, 0, 0);
-    y->set(&y, 2, 1, 1);
-    y->set(&y, 3, 0, 1);
-    y->set(&y, 3, 1, 0);
+    // the samples are used in place
+    fdouble inputs[4][2] = {{0, 0}, {0, 1}, {1, 0}, {1, 1}};
+    fdouble targets[4][2] = {{1, 0}, {0, 1}, {0, 1}, {1, 0}};
+    cml_matrix *x = cml_matrix_wrap(&inputs[0][0], 4, 2, 0, NULL, NULL);
+    cml_matrix *y = cml_matrix_wrap(&targets[0][0], 4, 2, 0, NULL, NULL);
 
     cml_layer *layers[] = {
         cml_layer_create(45, RELU),
@@ -44,31 +30,31 @@ int main(void)
     const lgint epochs = 100000;
     model->fit(model, x, y, &learning_rate, alpha, epochs);
 
-    y->print(y);
+    y->vt->print(y);
     cml_matrix *yhat = model->predict(model, x);
     if (yhat)
     {
-        yhat->softmax(&yhat);
-        yhat->print(yhat);
+        yhat->vt->softmax(&yhat);
+        yhat->vt->print(yhat);
 
         cml_matrix *conf = cml_matrix_confusion(yhat, y);
-        conf->print(conf);
-        conf->free(&conf);
+        conf->vt->print(conf);
+        conf->vt->free(&conf);
 
         cml_matrix *prec = NULL, *accur = NULL, *f1_score = NULL;
         cml_class_metrics(&prec, &accur, &f1_score, yhat, y);
-        prec->print(prec);
-        accur->print(accur);
-        f1_score->print(f1_score);
-        prec->free(&prec);
-        accur->free(&accur);
-        f1_score->free(&f1_score);
-
-        yhat->free(&yhat);
+        prec->vt->print(prec);
+        accur->vt->print(accur);
+        f1_score->vt->print(f1_score);
+        prec->vt->free(&prec);
+        accur->vt->free(&accur);
+        f1_score->vt->free(&f1_score);
+
+        yhat->vt->free(&yhat);
     }
 
-    x->free(&x);
-    y->free(&y);
+    x->vt->free(&x);
+    y->vt->free(&y);
     model->free(&model);
     prng->free(&prng);
 
@@ -0,0 +1,54 @@
+#ifndef cml_allocator_h
+#define cml_allocator_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct cml_allocator cml_allocator;
+
+    // block of `size` bytes on a cache line boundary, NULL on failure
+    typedef void *cml_allocator_alloc(cml_allocator *const allocator, const size_t size);
+
+    // give back a block of `size` bytes obtained from `alloc`
+    typedef void cml_allocator_dealloc(cml_allocator *const allocator, void *ptr, const size_t size);
+
+    typedef void cml_allocator_free(cml_allocator **allocator);
+
+    // reclaim at once what `dealloc` leaves aside, see the implementations below
+    typedef void cml_allocator_reset(cml_allocator *const allocator);
+
+    // an allocator is not thread-safe, it serves the thread that owns it
+    struct cml_allocator
+    {
+        cml_allocator_alloc *alloc;
+        cml_allocator_dealloc *dealloc;
+        cml_allocator_free *free;
+        cml_allocator_reset *reset;
+    };
+
+    /*
+     * Bump allocator: a block is a pointer increment in a chunk of at least
+     * `capacity` bytes, `dealloc` does nothing and `reset` reclaims every
+     * block at once. When a chunk is full another one is chained, and the
+     * next `reset` merges them into one chunk big enough for the whole
+     * cycle, so that a steady workload allocates and faults its pages once.
+     */
+    cml_allocator *cml_arena_create(const size_t capacity);
+
+    /*
+     * Size-class allocator for recurring shapes: the blocks are rounded up
+     * to a power of two and `dealloc` keeps them on a free list of their
+     * class, to be handed out again without a call to the system. `reset`
+     * returns the cached blocks to the system.
+     */
+    cml_allocator *cml_size_pool_create(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
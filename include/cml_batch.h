@@ -0,0 +1,47 @@
+#ifndef cml_batch_h
+#define cml_batch_h
+
+#include "cml_matrix.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// largest dimension of the matrices of a stack
+#define CML_BATCH_MAX_N 8
+
+    /*
+     * Batched operations on stacks of many small matrices of the same
+     * shape, e.g. hundreds of thousands of 3x3 systems. A stack of `count`
+     * matrices (m, n) is a matrix (count, m*n) whose row b holds the matrix
+     * b row by row. The results are written into the preallocated stack
+     * OUT of the same type, which is returned (NULL on error) and may be an
+     * operand itself. No matrix is allocated and the arguments are checked
+     * once for the whole stack: blocks of as many matrices as a vector
+     * register holds elements are processed side by side, with kernels
+     * specialized for each size and vectorized across the matrices of a
+     * block, and the blocks are split over the threads.
+     *
+     * A singular matrix, whose pivot falls below 1E-09 times the largest
+     * magnitude of its column (1E-06 in single precision), has a zero
+     * determinant, and its inverse or solution is filled with NaN.
+     */
+
+    // determinants of the stack A of (n, n) matrices into OUT (count, 1)
+    cml_matrix *cml_batch_det(const lgint n, cml_matrix *const a, cml_matrix *out);
+
+    // inverses of the stack A of (n, n) matrices into the stack OUT
+    cml_matrix *cml_batch_inv(const lgint n, cml_matrix *const a, cml_matrix *out);
+
+    // products A*B of the stacks A of (m, k) and B of (k, n) matrices into the stack OUT of (m, n) matrices
+    cml_matrix *cml_batch_prod(const lgint m, const lgint k, const lgint n, cml_matrix *const a, cml_matrix *const b, cml_matrix *out);
+
+    // X such that A*X = B for the stacks A of (n, n) and B of (n, k) matrices, by Gaussian elimination with partial pivoting, into the stack OUT
+    cml_matrix *cml_batch_solve(const lgint n, const lgint k, cml_matrix *const a, cml_matrix *const b, cml_matrix *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,6 +12,11 @@ extern "C"
 
     void cml_data_read(cml_matrix **x, cml_matrix **y, const char *file_path, const char *delimiter, bool has_header);
 
+    /*
+     * Split the rows of (X, Y) into train, validation and test parts. Without
+     * shuffling the parts are views of X and Y (see `cml_matrix_view`), they
+     * are copies otherwise. Either way each part is released with `free`.
+     */
     void cml_data_split(
         cml_matrix **train_data_x, cml_matrix **train_data_y,
         cml_matrix **val_data_x, cml_matrix **val_data_y,
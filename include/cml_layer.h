@@ -4,6 +4,7 @@
 #include "cml_activation.h"
 #include "cml_matrix.h"
 #include "cml_prng.h"
+#include "cml_sparse.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -14,14 +15,33 @@ extern "C"
 
     typedef cml_matrix *cml_layer_bias(cml_layer *const layer);
 
+    // convert the weights and the bias of a compiled layer to `dtype`
+    typedef void cml_layer_cast(cml_layer *const layer, const cml_dtype dtype);
+
     typedef void cml_layer_compile(cml_layer *const layer, const lgint n_inputs, cml_prng *const prng);
 
     typedef cml_matrix *cml_layer_eval(cml_layer *const layer, cml_matrix *const x);
 
+    // eval into the caller-supplied matrix `out` (x->m, units), returns `out` (NULL on error)
+    typedef cml_matrix *cml_layer_eval_into(cml_layer *const layer, cml_matrix *const x, cml_matrix *out);
+
+    // eval_into for the sparse X, e.g. the one-hot input of the first layer
+    typedef cml_matrix *cml_layer_eval_sparse_into(cml_layer *const layer, cml_sparse *const x, cml_matrix *out);
+
+    // eval_into that also stores the derivative of the activation, as gradient_into would compute it, into
+    // `grad` (x->m, units): a training step gets both from a single product
+    typedef cml_matrix *cml_layer_forward_into(cml_layer *const layer, cml_matrix *const x, cml_matrix *out, cml_matrix *grad);
+
+    typedef cml_matrix *cml_layer_forward_sparse_into(cml_layer *const layer, cml_sparse *const x, cml_matrix *out, cml_matrix *grad);
+
     typedef void cml_layer_free(cml_layer **layer);
 
     typedef cml_matrix *cml_layer_gradient(cml_layer *const layer, cml_matrix *const x);
 
+    typedef cml_matrix *cml_layer_gradient_into(cml_layer *const layer, cml_matrix *const x, cml_matrix *out);
+
+    typedef cml_matrix *cml_layer_gradient_sparse_into(cml_layer *const layer, cml_sparse *const x, cml_matrix *out);
+
     typedef void cml_layer_print(cml_layer *const layer);
 
     typedef cml_matrix *cml_layer_weight(cml_layer *const layer);
@@ -32,10 +52,17 @@ extern "C"
         const cml_activation activation;
 
         cml_layer_bias *bias;
+        cml_layer_cast *cast;
         cml_layer_compile *compile;
         cml_layer_eval *eval;
+        cml_layer_eval_into *eval_into;
+        cml_layer_eval_sparse_into *eval_sparse_into;
+        cml_layer_forward_into *forward_into;
+        cml_layer_forward_sparse_into *forward_sparse_into;
         cml_layer_free *free;
         cml_layer_gradient *gradient;
+        cml_layer_gradient_into *gradient_into;
+        cml_layer_gradient_sparse_into *gradient_sparse_into;
         cml_layer_print *print;
         cml_layer_weight *weight;
     };
@@ -0,0 +1,51 @@
+#ifndef cml_lu_h
+#define cml_lu_h
+
+#include "cml_matrix.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct cml_lu cml_lu;
+
+    typedef fdouble cml_lu_det(cml_lu *const lu);
+
+    typedef void cml_lu_free(cml_lu **lu);
+
+    // inverse of A, of the type of A
+    typedef cml_matrix *cml_lu_inv(cml_lu *const lu);
+
+    // X such that A*X = B for B (n, k), of the type of B
+    typedef cml_matrix *cml_lu_solve(cml_lu *const lu, cml_matrix *const b);
+
+    // explicit factors P*A = L*U, of the type of A
+    typedef void cml_lu_unpack(cml_lu *const lu, cml_matrix **p, cml_matrix **l, cml_matrix **u);
+
+    struct cml_lu
+    {
+        const lgint n;
+
+        cml_lu_det *det;
+        cml_lu_free *free;
+        cml_lu_inv *inv;
+        cml_lu_solve *solve;
+        cml_lu_unpack *unpack;
+    };
+
+    /*
+     * Factorization P*A = L*U of the square matrix A with partial pivoting,
+     * packed in place in one matrix (L below the diagonal with its unit
+     * diagonal implied, U on and above it) plus a vector of row pivots. It
+     * is computed once in double precision by a right-looking blocked
+     * algorithm whose trailing updates are products, and then serves any
+     * number of determinants, inverses and solves. NULL when A is singular.
+     */
+    cml_lu *cml_lu_create(cml_matrix *const a);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,8 +1,16 @@
 #ifndef cml_matrix_h
 #define cml_matrix_h
 
+#include "cml_allocator.h"
+
+#include <stdbool.h>
 #include <stddef.h>
 
+#ifdef CML_CHECKED
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -12,14 +20,42 @@ extern "C"
 
     typedef size_t lgint;
 
+    // element type of a matrix, operands of an operation share the same one
+    typedef enum cml_dtype
+    {
+        FLOAT64 = 0,
+        FLOAT32
+    } cml_dtype;
+
+    // reduction of the elements of a row or of a column of a matrix
+    typedef enum cml_reduction
+    {
+        REDUCE_SUM = 0,
+        REDUCE_MEAN,
+        REDUCE_MAX,
+        REDUCE_MIN,
+        REDUCE_ARGMAX,
+        REDUCE_LOGSUMEXP,
+        REDUCE_NORM2
+    } cml_reduction;
+
     typedef struct cml_matrix cml_matrix;
 
+    /*
+     * Copy of A in O(1): the copy shares the elements of A, and they are
+     * copied by the first write to either matrix through `set` or any
+     * function of the library. Views of A and the matrices drawn from an
+     * allocator are copied at once.
+     */
     typedef cml_matrix *cml_matrix_copy(cml_matrix *const a);
 
     typedef fdouble cml_matrix_det(cml_matrix *const a);
 
     typedef void cml_matrix_free(cml_matrix **a);
 
+    // release of the elements adopted by cml_matrix_wrap, called by `free` with the context given there
+    typedef void cml_matrix_deleter(void *data, void *ctx);
+
     typedef fdouble cml_matrix_get(cml_matrix *const a, const lgint i, const lgint j);
 
     typedef cml_matrix *cml_matrix_hadamard(cml_matrix *const a, cml_matrix *const b);
@@ -28,6 +64,7 @@ extern "C"
 
     typedef void cml_matrix_lu(cml_matrix *const a, cml_matrix **p, cml_matrix **l, cml_matrix **u);
 
+    // copy of A whose columns are divided by their largest magnitude, into [-1, 1], see also cml_scaler.h
     typedef cml_matrix *cml_matrix_normalize(cml_matrix *const a);
 
     typedef void cml_matrix_print(cml_matrix *const a);
@@ -38,13 +75,12 @@ extern "C"
 
     typedef fdouble cml_matrix_trace(cml_matrix *const a);
 
+    // `*at` is allocated when NULL, a square matrix is transposed in place when `*at` is `a`
     typedef void cml_matrix_transpose(cml_matrix *const a, cml_matrix **at);
 
-    struct cml_matrix
+    // operations of a matrix, shared by all matrices: `a->vt->get(a, i, j)`
+    typedef struct cml_matrix_vtable
     {
-        const lgint m;
-        const lgint n;
-
         cml_matrix_copy *copy;
         cml_matrix_det *det;
         cml_matrix_free *free;
@@ -58,24 +94,250 @@ extern "C"
         cml_matrix_softmax *softmax;
         cml_matrix_trace *trace;
         cml_matrix_transpose *transpose;
+    } cml_matrix_vtable;
+
+    struct cml_matrix
+    {
+        const lgint m;
+        const lgint n;
+        const cml_dtype dtype;
+
+        /* Distance in elements between two rows and first element, see cml_matrix_data() */
+        const lgint ld;
+        void *const data;
+
+        const cml_matrix_vtable *const vt;
     };
 
+    /*
+     * Direct access to the elements, for loops that `get` and `set` would
+     * slow down with an indirect call and a bounds check per element. The
+     * elements are row-major, the row i starting `i*a->ld` elements after
+     * the first one, and `a->ld` may exceed `a->n` (views, padded rows).
+     * `cml_matrix_data` and `cml_matrix_row` are NULL for a FLOAT32 matrix,
+     * whose elements are reached with their `_f32` counterparts.
+     *
+     * A matrix may share its elements with its copies (see `copy`): call
+     * `cml_matrix_unshare` before writing to them directly.
+     *
+     * Nothing is checked unless the library and the caller are compiled
+     * with CML_CHECKED defined (`make debug`): an index outside of the
+     * matrix or a wrong type then aborts with the location of the access.
+     */
+#ifdef CML_CHECKED
+    static inline void *cml_matrix_checked(cml_matrix *const a, const lgint i, const lgint j, const cml_dtype dtype, const char *file, const int line)
+    {
+        if (a == NULL || a->dtype != dtype || i >= a->m || j >= a->n)
+        {
+            fprintf(stderr, "error (%s:%d): invalid access to the element (%zu, %zu) of a matrix.\n", file, line, i, j);
+            abort();
+        }
+        return (char *)a->data + (i * a->ld + j) * ((dtype == FLOAT32) ? sizeof(float) : sizeof(fdouble));
+    }
+#define CML_MATRIX_AT(a, i, j) (*(fdouble *)cml_matrix_checked((a), (i), (j), FLOAT64, __FILE__, __LINE__))
+#define CML_MATRIX_AT_F32(a, i, j) (*(float *)cml_matrix_checked((a), (i), (j), FLOAT32, __FILE__, __LINE__))
+#else
+// element (i, j) of a FLOAT64 matrix, or of a FLOAT32 one, as an lvalue
+#define CML_MATRIX_AT(a, i, j) (((fdouble *)(a)->data)[(i) * (a)->ld + (j)])
+#define CML_MATRIX_AT_F32(a, i, j) (((float *)(a)->data)[(i) * (a)->ld + (j)])
+#endif
+
+    static inline fdouble *cml_matrix_data(cml_matrix *const a)
+    {
+        return (a->dtype == FLOAT64) ? (fdouble *)a->data : NULL;
+    }
+
+    static inline float *cml_matrix_data_f32(cml_matrix *const a)
+    {
+        return (a->dtype == FLOAT32) ? (float *)a->data : NULL;
+    }
+
+    static inline fdouble *cml_matrix_row(cml_matrix *const a, const lgint i)
+    {
+        return (a->dtype == FLOAT64) ? &CML_MATRIX_AT(a, i, 0) : NULL;
+    }
+
+    static inline float *cml_matrix_row_f32(cml_matrix *const a, const lgint i)
+    {
+        return (a->dtype == FLOAT32) ? &CML_MATRIX_AT_F32(a, i, 0) : NULL;
+    }
+
+    // element (i, j) converted from/to fdouble whatever the type of the matrix, without `get` and `set`
+    static inline fdouble cml_matrix_load(cml_matrix *const a, const lgint i, const lgint j)
+    {
+        if (a->dtype == FLOAT32)
+            return CML_MATRIX_AT_F32(a, i, j);
+        return CML_MATRIX_AT(a, i, j);
+    }
+
+    static inline void cml_matrix_store(cml_matrix *const a, const lgint i, const lgint j, const fdouble value)
+    {
+        if (a->dtype == FLOAT32)
+            CML_MATRIX_AT_F32(a, i, j) = (float)value;
+        else
+            CML_MATRIX_AT(a, i, j) = value;
+    }
+
     cml_matrix *cml_matrix_alloc(const lgint m, const lgint n);
 
+    cml_matrix *cml_matrix_alloc_dtype(const lgint m, const lgint n, const cml_dtype dtype);
+
+    /*
+     * Matrix whose rows are `ld` >= n elements apart. With ld = 0, the rows
+     * are padded to an odd number of cache lines, which keeps SIMD loads
+     * within a line and avoids cache-set conflicts for power-of-two widths.
+     * Every operation honors the padding.
+     */
+    cml_matrix *cml_matrix_alloc_ld(const lgint m, const lgint n, const lgint ld, const cml_dtype dtype);
+
+    /*
+     * Matrix drawn from `allocator`, e.g. an arena for the temporaries of a
+     * computation. It is released with `free` like any other, which hands
+     * it back to the allocator: it must not be used once the allocator is
+     * reset or freed.
+     */
+    cml_matrix *cml_matrix_alloc_with(cml_allocator *const allocator, const lgint m, const lgint n, const cml_dtype dtype);
+
+    // copy of A converted to `dtype`
+    cml_matrix *cml_matrix_cast(cml_matrix *const a, const cml_dtype dtype);
+
+    /*
+     * Lower triangular L with A = L*L^T for the symmetric positive definite
+     * A, of the type of A. Only the upper triangle of A is read. Returns
+     * NULL when A is not positive definite, which makes it a cheap test of
+     * definiteness at half the cost of an LU factorization.
+     */
+    cml_matrix *cml_matrix_cholesky(cml_matrix *const a);
+
     cml_matrix *cml_matrix_confusion(cml_matrix *const yhat, cml_matrix *const y);
 
+    /*
+     * The `_into` variants write the result into the caller-supplied matrix
+     * `out` of the right shape instead of allocating it, and return `out`
+     * (NULL on error). Element-wise operations accept `out` aliasing an
+     * operand, the product does not.
+     */
+    cml_matrix *cml_matrix_copy_into(cml_matrix *const a, cml_matrix *out);
+
     cml_matrix *cml_matrix_dif(cml_matrix *const a, cml_matrix *const b);
 
+    cml_matrix *cml_matrix_dif_into(cml_matrix *const a, cml_matrix *const b, cml_matrix *out);
+
+    /*
+     * Eigendecomposition A = V*diag(w)*V^T of the symmetric A(n, n): the
+     * eigenvalues w (n, 1) in decreasing order and the orthonormal
+     * eigenvectors in the columns of V(n, n), of the type of A. Only the
+     * lower triangle of A is read. w and V are NULL on error.
+     */
+    void cml_matrix_eigh(cml_matrix *const a, cml_matrix **w, cml_matrix **v);
+
     cml_matrix *cml_matrix_eye(const lgint n);
 
+    /*
+     * C <= alpha*op(A)*op(B) + beta*C, where op(X) is X^T when `trans_x` is
+     * true and X otherwise. The operands are read in place, no transpose is
+     * formed. Returns C (NULL on error), C is not read when beta is 0.
+     */
+    cml_matrix *cml_matrix_gemm(const bool trans_a, const bool trans_b, const fdouble alpha,
+                                cml_matrix *const a, cml_matrix *const b,
+                                const fdouble beta, cml_matrix *c);
+
+    cml_matrix *cml_matrix_hadamard_into(cml_matrix *const a, cml_matrix *const b, cml_matrix *out);
+
+    /*
+     * X(n, k) minimizing ||A*X - B|| for A(m, n) of full rank with m >= n,
+     * of the type of B. It goes through a Householder QR factorization of A,
+     * so X^T*X is never formed and the conditioning is not squared.
+     */
+    cml_matrix *cml_matrix_lstsq(cml_matrix *const a, cml_matrix *const b);
+
+    cml_matrix *cml_matrix_normalize_into(cml_matrix *const a, cml_matrix *out);
+
     cml_matrix *cml_matrix_prod(cml_matrix *const a, cml_matrix *const b);
 
+    cml_matrix *cml_matrix_prod_into(cml_matrix *const a, cml_matrix *const b, cml_matrix *out);
+
+    // A*B^T
+    cml_matrix *cml_matrix_prod_nt(cml_matrix *const a, cml_matrix *const b);
+
+    // A^T*B
+    cml_matrix *cml_matrix_prod_tn(cml_matrix *const a, cml_matrix *const b);
+
+    /*
+     * Reduction of each column of A(m, n) into the vector `out` of n
+     * elements, (n, 1) or (1, n) and of the type of A, which is returned
+     * (NULL on error). The rows are folded into the result with SIMD
+     * kernels, and wide matrices are split by columns over the threads.
+     * REDUCE_ARGMAX stores the first row of the maximum, and REDUCE_LOGSUMEXP
+     * is the maximum itself when it is not finite (-inf for a fully masked
+     * column, +inf when one holds +inf).
+     */
+    cml_matrix *cml_matrix_reduce_columns(const cml_reduction op, cml_matrix *const a, cml_matrix *out);
+
+    // reduction of each row of A(m, n) into the vector `out` of m elements, see cml_matrix_reduce_columns
+    cml_matrix *cml_matrix_reduce_rows(const cml_reduction op, cml_matrix *const a, cml_matrix *out);
+
+    // thin QR factorization A(m, n) = Q*R for m >= n: Q(m, n) has orthonormal columns and R(n, n) is upper triangular
+    void cml_matrix_qr(cml_matrix *const a, cml_matrix **q, cml_matrix **r);
+
+    // X such that A*X = B by LU factorization and substitution, the k columns of B(n, k) are solved at once
     cml_matrix *cml_matrix_solve(cml_matrix *const a, cml_matrix *const b);
 
+    // X such that A*X = B for the symmetric positive definite A, by Cholesky factorization, e.g. the normal equations X^T*X*w = X^T*y
+    cml_matrix *cml_matrix_solve_spd(cml_matrix *const a, cml_matrix *const b);
+
     cml_matrix *cml_matrix_sum(cml_matrix *const a, cml_matrix *const b);
 
+    cml_matrix *cml_matrix_sum_into(cml_matrix *const a, cml_matrix *const b, cml_matrix *out);
+
+    /*
+     * Truncated SVD A ~ U*diag(s)*V^T of rank k <= min(m, n) for A(m, n):
+     * U(m, k) and V(n, k) with orthonormal columns and the k largest
+     * singular values in s (k, 1), of the type of A. It is randomized: A
+     * only enters products with a few (m, k + 10) and (n, k + 10) blocks,
+     * which costs O(m*n*k) instead of the O(m*n*min(m, n)) of a full SVD.
+     * The random draws are seeded the same at each call, so the result is
+     * reproducible. U, s and V are NULL on error.
+     */
+    void cml_matrix_svd(cml_matrix *const a, const lgint k, cml_matrix **u, cml_matrix **s, cml_matrix **v);
+
+    // X^T*X, only one triangle is computed and mirrored: half the multiply-adds of cml_matrix_prod_tn(x, x)
+    cml_matrix *cml_matrix_syrk(cml_matrix *const x);
+
+    // gives A elements of its own if it shares them with copies, before writing to them through cml_matrix_data or CML_MATRIX_AT; returns A (NULL on error)
+    cml_matrix *cml_matrix_unshare(cml_matrix *const a);
+
+    /*
+     * A view is a matrix (m, n) sharing the elements of `a` from (i, j),
+     * taking every `step`-th row. Nothing is copied: writing to the view
+     * writes to `a`, which is why `a` no longer shares its elements with
+     * copies once a view has been taken. It is accepted wherever a matrix
+     * is, is released with `free` without touching `a`, and must not be
+     * used once `a` is freed.
+     */
+    cml_matrix *cml_matrix_view(cml_matrix *const a, const lgint i, const lgint j, const lgint m, const lgint n, const lgint step);
+
+    // view of the rows [i, i + m) of A, e.g. a mini-batch
+    cml_matrix *cml_matrix_view_rows(cml_matrix *const a, const lgint i, const lgint m);
+
+    /*
+     * Matrix (m, n) over the caller's row-major elements `data`, rows `ld`
+     * elements apart (ld = 0 for ld = n), without copying them: a block of
+     * features decoded elsewhere goes straight into any operation, `fit` or
+     * `predict`, and writes to the matrix land in `data`. `free` calls
+     * `deleter(data, ctx)`, unless it is NULL and the caller keeps the
+     * elements, which must then outlive the matrix. Its copies are eager.
+     * Returns NULL on error, and `data` is not adopted then.
+     */
+    cml_matrix *cml_matrix_wrap(fdouble *data, const lgint m, const lgint n, const lgint ld, cml_matrix_deleter *deleter, void *ctx);
+
+    // cml_matrix_wrap for single-precision elements, a FLOAT32 matrix
+    cml_matrix *cml_matrix_wrap_f32(float *data, const lgint m, const lgint n, const lgint ld, cml_matrix_deleter *deleter, void *ctx);
+
     cml_matrix *cml_matrix_zeros(const lgint m, const lgint n);
 
+    cml_matrix *cml_matrix_zeros_dtype(const lgint m, const lgint n, const cml_dtype dtype);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,25 @@
+#ifndef cml_parallel_h
+#define cml_parallel_h
+
+#include "cml_matrix.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /*
+     * Number of threads used by the matrix kernels, the calling thread included.
+     * It defaults to the environment variable CML_NUM_THREADS when set, and to
+     * the number of online processors otherwise. Passing 0 restores the default.
+     * The worker threads are started once and reused by every kernel.
+     */
+    void cml_set_num_threads(const lgint n);
+
+    lgint cml_get_num_threads(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
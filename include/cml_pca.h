@@ -0,0 +1,59 @@
+#ifndef cml_pca_h
+#define cml_pca_h
+
+#include "cml_matrix.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct cml_pca cml_pca;
+
+    // principal components of the rows of X(m, n), replacing those fitted before
+    typedef void cml_pca_fit(cml_pca *const pca, cml_matrix *const x);
+
+    typedef void cml_pca_free(cml_pca **pca);
+
+    // X(m, n) = Z*C + mean back from the projection Z(m, k), of the type of Z (NULL on error)
+    typedef cml_matrix *cml_pca_inverse_transform(cml_pca *const pca, cml_matrix *const z);
+
+    // projection Z(m, k) = (X - mean)*C^T of X(m, n) on the components, of the type of X (NULL on error)
+    typedef cml_matrix *cml_pca_transform(cml_pca *const pca, cml_matrix *const x);
+
+    /*
+     * Principal component analysis: the k directions of largest variance
+     * of the training data, on which any data can then be projected, e.g.
+     * to train a model on k < n inputs. Narrow data goes through the
+     * eigendecomposition of its covariance, wide data through a randomized
+     * SVD which only computes the k components. The sign of a component is
+     * chosen so that its largest element is positive.
+     */
+    struct cml_pca
+    {
+        // number of components
+        const lgint k;
+        // number of columns, 0 until the analysis is fitted
+        const lgint n;
+
+        // (k, n) components C in rows, by decreasing variance, NULL until fitted
+        cml_matrix *const components;
+        // (k, 1) variance along each component, and its fraction of the total variance
+        cml_matrix *const explained_variance;
+        cml_matrix *const explained_variance_ratio;
+        // (1, n) mean of the columns
+        cml_matrix *const mean;
+
+        cml_pca_fit *fit;
+        cml_pca_free *free;
+        cml_pca_inverse_transform *inverse_transform;
+        cml_pca_transform *transform;
+    };
+
+    cml_pca *cml_pca_create(const lgint k);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef cml_scaler_h
+#define cml_scaler_h
+
+#include "cml_matrix.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // transformation applied to each column (feature) by a scaler
+    typedef enum cml_scaling
+    {
+        MIN_MAX_SCALING = 0, // (x - min) / (max - min), into [0, 1]
+        STANDARD_SCALING     // (x - mean) / std, zero mean and unit variance
+    } cml_scaling;
+
+    typedef struct cml_scaler cml_scaler;
+
+    // statistics of the columns of X, replacing those fitted before
+    typedef void cml_scaler_fit(cml_scaler *const scaler, cml_matrix *const x);
+
+    typedef void cml_scaler_free(cml_scaler **scaler);
+
+    // X <= the unscaled X in place, returns X (NULL on error)
+    typedef cml_matrix *cml_scaler_inverse_transform(cml_scaler *const scaler, cml_matrix *x);
+
+    // statistics of the columns of X merged into those fitted so far, e.g. for data read in batches
+    typedef void cml_scaler_partial_fit(cml_scaler *const scaler, cml_matrix *const x);
+
+    // write the fitted statistics to `file_path`, to be read back with cml_scaler_load
+    typedef bool cml_scaler_save(cml_scaler *const scaler, const char *file_path);
+
+    // X <= the scaled X in place, returns X (NULL on error)
+    typedef cml_matrix *cml_scaler_transform(cml_scaler *const scaler, cml_matrix *x);
+
+    /*
+     * Feature scaler: it is fitted once on the training data and then
+     * applies the same transformation to any data, test and production
+     * alike. The statistics (count, mean, variance, min and max of each
+     * column) are gathered in a single pass over the rows, split over the
+     * threads whose partial statistics are merged, and kept in double
+     * precision whatever the type of the data.
+     */
+    struct cml_scaler
+    {
+        const cml_scaling scaling;
+        // number of columns, 0 until the scaler is fitted
+        const lgint n;
+
+        cml_scaler_fit *fit;
+        cml_scaler_free *free;
+        cml_scaler_inverse_transform *inverse_transform;
+        cml_scaler_partial_fit *partial_fit;
+        cml_scaler_save *save;
+        cml_scaler_transform *transform;
+    };
+
+    cml_scaler *cml_scaler_create(const cml_scaling scaling);
+
+    // scaler saved by `save`, NULL when the file can not be read
+    cml_scaler *cml_scaler_load(const char *file_path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
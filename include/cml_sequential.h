@@ -7,6 +7,7 @@
 #include "cml_matrix.h"
 #include "cml_optimizer.h"
 #include "cml_prng.h"
+#include "cml_sparse.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -19,10 +20,15 @@ extern "C"
 
     typedef void cml_sequential_fit(cml_sequential *const model, cml_matrix *const x, cml_matrix *const y, fdouble (*learning_rate)(fdouble alpha), const fdouble alpha, const lgint epochs);
 
+    // fit on the sparse X, only its stored elements enter the products of the first layer
+    typedef void cml_sequential_fit_sparse(cml_sequential *const model, cml_sparse *const x, cml_matrix *const y, fdouble (*learning_rate)(fdouble alpha), const fdouble alpha, const lgint epochs);
+
     typedef void cml_sequential_free(cml_sequential **model);
 
     typedef cml_matrix *cml_sequential_predict(cml_sequential *const model, cml_matrix *const x);
 
+    typedef cml_matrix *cml_sequential_predict_sparse(cml_sequential *const model, cml_sparse *const x);
+
     typedef void cml_sequential_summary(cml_sequential *const model);
 
     struct cml_sequential
@@ -31,11 +37,14 @@ extern "C"
         const lgint n_layers;
         const lgint n_inputs;
         const cml_loss loss;
+        const cml_dtype dtype;
 
         cml_sequential_compile *compile;
         cml_sequential_fit *fit;
+        cml_sequential_fit_sparse *fit_sparse;
         cml_sequential_free *free;
         cml_sequential_predict *predict;
+        cml_sequential_predict_sparse *predict_sparse;
         cml_sequential_summary *summary;
     };
 
@@ -48,6 +57,13 @@ extern "C"
 
     cml_sequential *cml_sequential_create(cml_layer *layers[], const lgint n_layers, const lgint n_inputs, const cml_loss loss);
 
+    /*
+     * Model whose weights, activations and gradients are stored as `dtype`.
+     * Inputs of another type are converted on entry to fit and predict, the
+     * predictions are of type `dtype`.
+     */
+    cml_sequential *cml_sequential_create_dtype(cml_layer *layers[], const lgint n_layers, const lgint n_inputs, const cml_loss loss, const cml_dtype dtype);
+
 #ifdef __cplusplus
 }
 #endif
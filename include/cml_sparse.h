@@ -0,0 +1,66 @@
+#ifndef cml_sparse_h
+#define cml_sparse_h
+
+#include "cml_matrix.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct cml_sparse cml_sparse;
+
+    typedef void cml_sparse_free(cml_sparse **a);
+
+    // element (i, j), 0 when it is not stored
+    typedef fdouble cml_sparse_get(cml_sparse *const a, const lgint i, const lgint j);
+
+    typedef void cml_sparse_print(cml_sparse *const a);
+
+    typedef cml_matrix *cml_sparse_to_dense(cml_sparse *const a);
+
+    /*
+     * Matrix (m, n) in compressed sparse row format: only the `nnz` non-zero
+     * elements are stored, row by row, with their column index. Memory and
+     * products scale with `nnz` instead of m*n, which pays off for inputs
+     * such as one-hot or hashed features. It is immutable once created.
+     */
+    struct cml_sparse
+    {
+        const lgint m;
+        const lgint n;
+        const lgint nnz;
+        const cml_dtype dtype;
+
+        cml_sparse_free *free;
+        cml_sparse_get *get;
+        cml_sparse_print *print;
+        cml_sparse_to_dense *to_dense;
+    };
+
+    // copy of A converted to `dtype`
+    cml_sparse *cml_sparse_cast(cml_sparse *const a, const cml_dtype dtype);
+
+    /*
+     * Sparse matrix (m, n) from CSR arrays, which are copied: the elements
+     * of row i are `values[rows[i]:rows[i + 1]]` in the columns `cols[...]`,
+     * rows[m] being the number of elements. The columns of a row must be
+     * increasing.
+     */
+    cml_sparse *cml_sparse_create(const lgint m, const lgint n, const lgint *rows, const lgint *cols, const fdouble *values, const cml_dtype dtype);
+
+    // the non-zero elements of A, of the type of A
+    cml_sparse *cml_sparse_from_dense(cml_matrix *const a);
+
+    /*
+     * C <= alpha*op(A)*B + beta*C for the sparse A, where op(A) is A^T when
+     * `trans_a` is true and A otherwise. Only the stored elements of A are
+     * visited. Returns C (NULL on error), C is not read when beta is 0.
+     */
+    cml_matrix *cml_sparse_gemm(const bool trans_a, const fdouble alpha, cml_sparse *const a, cml_matrix *const b, const fdouble beta, cml_matrix *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
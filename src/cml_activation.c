@@ -1,10 +1,8 @@
 #include "cml_activation.h"
+#include "cml_activation_impl.h"
 
-#include <math.h>
 #include <stdlib.h>
 
-#define LEAKY_RELU_COEF 0.01
-
 const char *cml_activation_name(const cml_activation *const activation)
 {
     switch (*activation)
@@ -28,49 +26,45 @@ const char *cml_activation_name(const cml_activation *const activation)
 
 fdouble eval_linear(const fdouble x)
 {
-    return x;
+    return activation_linear(x);
 }
-fdouble eval_linear_grad(const fdouble)
+fdouble eval_linear_grad(const fdouble x)
 {
-    return 1.;
+    return activation_linear_grad(x);
 }
 
 fdouble eval_relu(const fdouble x)
 {
-    return (x > 0) ? x : 0;
+    return activation_relu(x);
 }
 fdouble eval_relu_grad(const fdouble x)
 {
-    return (x > 0) ? 1 : 0;
+    return activation_relu_grad(x);
 }
 
 fdouble eval_leaky_relu(const fdouble x)
 {
-    return (x > 0) ? x : LEAKY_RELU_COEF * x;
+    return activation_leaky_relu(x);
 }
 fdouble eval_leaky_relu_grad(const fdouble x)
 {
-    return (x > 0) ? 1 : LEAKY_RELU_COEF;
+    return activation_leaky_relu_grad(x);
 }
 
 fdouble eval_sigmoid(const fdouble x)
 {
-    return 1. / (1. + exp(-x));
+    return activation_sigmoid(x);
 }
 fdouble eval_sigmoid_grad(const fdouble x)
 {
-    return eval_sigmoid(x) * (1 - eval_sigmoid(x));
+    return activation_sigmoid_grad(x);
 }
 
 fdouble eval_tanh(const fdouble x)
 {
-    const fdouble e1 = exp(x);
-    const fdouble e2 = exp(-x);
-
-    return (e1 - e2) / (e1 + e2);
+    return activation_tanh(x);
 }
 fdouble eval_tanh_grad(const fdouble x)
 {
-    const fdouble y = eval_tanh(x);
-    return 1 - y * y;
+    return activation_tanh_grad(x);
 }
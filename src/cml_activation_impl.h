@@ -0,0 +1,89 @@
+#ifndef cml_activation_impl_h
+#define cml_activation_impl_h
+
+#include "cml_activation.h"
+
+#include <float.h>
+#include <math.h>
+
+// slope of LEAKY_RELU for negative inputs
+#define CML_LEAKY_RELU_COEF 0.01
+
+// the activations and their derivatives, inlined into the loops that apply them to whole tiles
+static inline fdouble activation_linear(const fdouble x)
+{
+    return x;
+}
+
+static inline fdouble activation_linear_grad(const fdouble)
+{
+    return 1.;
+}
+
+static inline fdouble activation_relu(const fdouble x)
+{
+    return (x > 0) ? x : 0;
+}
+
+static inline fdouble activation_relu_grad(const fdouble x)
+{
+    return (x > 0) ? 1 : 0;
+}
+
+static inline fdouble activation_leaky_relu(const fdouble x)
+{
+    return (x > 0) ? x : CML_LEAKY_RELU_COEF * x;
+}
+
+static inline fdouble activation_leaky_relu_grad(const fdouble x)
+{
+    return (x > 0) ? 1 : CML_LEAKY_RELU_COEF;
+}
+
+static inline fdouble activation_sigmoid(const fdouble x)
+{
+    return 1. / (1. + exp(-x));
+}
+
+static inline fdouble activation_sigmoid_grad(const fdouble x)
+{
+    return activation_sigmoid(x) * (1 - activation_sigmoid(x));
+}
+
+static inline fdouble activation_tanh(const fdouble x)
+{
+    const fdouble e1 = exp(x);
+    const fdouble e2 = exp(-x);
+
+    return (e1 - e2) / (e1 + e2);
+}
+
+static inline fdouble activation_tanh_grad(const fdouble x)
+{
+    const fdouble y = activation_tanh(x);
+    return 1 - y * y;
+}
+
+// the exponential, normalized over the row afterwards for the value but not for the derivative
+static inline fdouble activation_softmax(const fdouble x)
+{
+    return exp(x);
+}
+
+static inline fdouble activation_softmax_grad(const fdouble x)
+{
+    return exp(x);
+}
+
+// value and derivative of an activation out of the enumeration
+static inline fdouble activation_unknown(const fdouble)
+{
+    return DBL_MAX;
+}
+
+static inline fdouble activation_unknown_grad(const fdouble)
+{
+    return DBL_MAX;
+}
+
+#endif
@@ -0,0 +1,265 @@
+#include "cml_allocator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+// alignment in bytes of every block, a cache line
+#define CML_ALLOCATOR_ALIGN 64
+
+// size in bytes above which the memory is requested on huge pages
+#define CML_ALLOCATOR_HUGEPAGE_SIZE (4 << 20)
+
+// number of size classes of a pool, from 64 bytes to 2^(6 + n - 1) bytes
+#define CML_POOL_CLASSES 48
+
+static size_t allocator_round(const size_t size)
+{
+    return (size + CML_ALLOCATOR_ALIGN - 1) / CML_ALLOCATOR_ALIGN * CML_ALLOCATOR_ALIGN;
+}
+
+// block of `size` bytes from the system, 2 MiB aligned and backed by huge
+// pages when it is large enough for it to matter
+static void *allocator_system_alloc(const size_t size)
+{
+    void *ptr = NULL;
+    const size_t alignment = (size < CML_ALLOCATOR_HUGEPAGE_SIZE) ? CML_ALLOCATOR_ALIGN : (2 << 20);
+    if (posix_memalign(&ptr, alignment, size) != 0)
+        return NULL;
+#ifdef MADV_HUGEPAGE
+    if (size >= CML_ALLOCATOR_HUGEPAGE_SIZE)
+        madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    return ptr;
+}
+
+/* Arena */
+
+struct arena_chunk
+{
+    struct arena_chunk *next;
+    size_t size;
+    size_t used;
+
+    char data[] __attribute__((aligned(CML_ALLOCATOR_ALIGN)));
+};
+
+struct arena
+{
+    /* Public interface */
+    cml_allocator pub;
+
+    /* Chunk being filled first, the ones it replaced follow */
+    struct arena_chunk *head;
+
+    /* Size of the first chunk and sum of the chunk sizes */
+    size_t capacity;
+    size_t total;
+};
+
+static void *arena_alloc(cml_allocator *const allocator, const size_t size);
+static void arena_dealloc(cml_allocator *const allocator, void *ptr, const size_t size);
+static void arena_free(cml_allocator **allocator);
+static void arena_reset(cml_allocator *const allocator);
+
+static struct arena_chunk *arena_chunk_create(const size_t size)
+{
+    struct arena_chunk *chunk = (struct arena_chunk *)allocator_system_alloc(sizeof(*chunk) + size);
+    if (chunk == NULL)
+        return NULL;
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+static void arena_release(struct arena *arena)
+{
+    while (arena->head != NULL)
+    {
+        struct arena_chunk *next = arena->head->next;
+        free(arena->head);
+        arena->head = next;
+    }
+    arena->total = 0;
+}
+
+cml_allocator *cml_arena_create(const size_t capacity)
+{
+    struct arena *arena = (struct arena *)malloc(sizeof(*arena));
+    if (arena == NULL)
+    {
+        fprintf(stderr, "error (cml_arena_create): the allocation memory of the arena has failed.\n");
+        return NULL;
+    }
+    arena->pub.alloc = &arena_alloc;
+    arena->pub.dealloc = &arena_dealloc;
+    arena->pub.free = &arena_free;
+    arena->pub.reset = &arena_reset;
+
+    arena->head = NULL;
+    arena->capacity = allocator_round((capacity > 0) ? capacity : 1);
+    arena->total = 0;
+
+    return &arena->pub;
+}
+
+void *arena_alloc(cml_allocator *const allocator, const size_t size)
+{
+    struct arena *arena = (struct arena *)allocator;
+    const size_t rounded = allocator_round((size > 0) ? size : 1);
+    struct arena_chunk *chunk = arena->head;
+    if (chunk == NULL || chunk->size - chunk->used < rounded)
+    {
+        // at least double the memory at each new chunk, so that a cycle chains few of them
+        size_t grow = (arena->total > arena->capacity) ? arena->total : arena->capacity;
+        if (grow < rounded)
+            grow = rounded;
+        chunk = arena_chunk_create(grow);
+        if (chunk == NULL)
+        {
+            fprintf(stderr, "error (arena_alloc): the allocation memory of a chunk of %zu bytes has failed.\n", grow);
+            return NULL;
+        }
+        chunk->next = arena->head;
+        arena->head = chunk;
+        arena->total += grow;
+    }
+    void *ptr = chunk->data + chunk->used;
+    chunk->used += rounded;
+    return ptr;
+}
+
+void arena_dealloc(cml_allocator *const allocator, void *ptr, const size_t size)
+{
+    // the blocks are reclaimed all at once by `reset`
+    (void)allocator;
+    (void)ptr;
+    (void)size;
+}
+
+void arena_free(cml_allocator **allocator)
+{
+    if (*allocator == NULL)
+        return;
+    arena_release((struct arena *)*allocator);
+    free(*allocator);
+    *allocator = NULL;
+}
+
+void arena_reset(cml_allocator *const allocator)
+{
+    struct arena *arena = (struct arena *)allocator;
+    if (arena->head == NULL)
+        return;
+    if (arena->head->next == NULL)
+    {
+        arena->head->used = 0;
+        return;
+    }
+
+    // the last cycle needed several chunks, the next one gets a single chunk as large as all of them
+    const size_t total = arena->total;
+    arena_release(arena);
+    arena->head = arena_chunk_create(total);
+    if (arena->head != NULL)
+        arena->total = total;
+}
+
+/* Size-class pool */
+
+struct size_pool
+{
+    /* Public interface */
+    cml_allocator pub;
+
+    /* Free blocks of 64 << k bytes, linked through their first word */
+    void *blocks[CML_POOL_CLASSES];
+};
+
+static void *size_pool_alloc(cml_allocator *const allocator, const size_t size);
+static void size_pool_dealloc(cml_allocator *const allocator, void *ptr, const size_t size);
+static void size_pool_free(cml_allocator **allocator);
+static void size_pool_reset(cml_allocator *const allocator);
+
+// smallest class whose blocks hold `size` bytes
+static int size_pool_class(const size_t size)
+{
+    int k = 0;
+    while (k < CML_POOL_CLASSES && ((size_t)CML_ALLOCATOR_ALIGN << k) < size)
+        k++;
+    return k;
+}
+
+cml_allocator *cml_size_pool_create(void)
+{
+    struct size_pool *pool = (struct size_pool *)malloc(sizeof(*pool));
+    if (pool == NULL)
+    {
+        fprintf(stderr, "error (cml_size_pool_create): the allocation memory of the pool has failed.\n");
+        return NULL;
+    }
+    pool->pub.alloc = &size_pool_alloc;
+    pool->pub.dealloc = &size_pool_dealloc;
+    pool->pub.free = &size_pool_free;
+    pool->pub.reset = &size_pool_reset;
+
+    for (int k = 0; k < CML_POOL_CLASSES; k++)
+        pool->blocks[k] = NULL;
+
+    return &pool->pub;
+}
+
+void *size_pool_alloc(cml_allocator *const allocator, const size_t size)
+{
+    struct size_pool *pool = (struct size_pool *)allocator;
+    const int k = size_pool_class(size);
+    if (k == CML_POOL_CLASSES)
+    {
+        fprintf(stderr, "error (size_pool_alloc): a block of %zu bytes is beyond the largest size class.\n", size);
+        return NULL;
+    }
+    void *ptr = pool->blocks[k];
+    if (ptr != NULL)
+    {
+        pool->blocks[k] = *(void **)ptr;
+        return ptr;
+    }
+    ptr = allocator_system_alloc((size_t)CML_ALLOCATOR_ALIGN << k);
+    if (ptr == NULL)
+        fprintf(stderr, "error (size_pool_alloc): the allocation memory of a block of %zu bytes has failed.\n", size);
+    return ptr;
+}
+
+void size_pool_dealloc(cml_allocator *const allocator, void *ptr, const size_t size)
+{
+    if (ptr == NULL)
+        return;
+    struct size_pool *pool = (struct size_pool *)allocator;
+    const int k = size_pool_class(size);
+    *(void **)ptr = pool->blocks[k];
+    pool->blocks[k] = ptr;
+}
+
+void size_pool_free(cml_allocator **allocator)
+{
+    if (*allocator == NULL)
+        return;
+    size_pool_reset(*allocator);
+    free(*allocator);
+    *allocator = NULL;
+}
+
+void size_pool_reset(cml_allocator *const allocator)
+{
+    struct size_pool *pool = (struct size_pool *)allocator;
+    for (int k = 0; k < CML_POOL_CLASSES; k++)
+    {
+        while (pool->blocks[k] != NULL)
+        {
+            void *next = *(void **)pool->blocks[k];
+            free(pool->blocks[k]);
+            pool->blocks[k] = next;
+        }
+    }
+}
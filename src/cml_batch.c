@@ -0,0 +1,207 @@
+#include "cml_batch.h"
+#include "cml_matrix_impl.h"
+#include "cml_pool.h"
+#include "cml_simd.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CML_BATCH_X86 1
+#endif
+
+// number of multiply-adds below which a batch runs on a single thread
+#define BATCH_GRAIN 65536
+
+// pivot magnitude, relative to the largest one of its column, below which a
+// matrix is taken as singular: the tolerance of cml_lu in double precision,
+// the rounding of a few operations in single precision
+#define BATCH_TOLERANCE_F64 1E-09
+#define BATCH_TOLERANCE_F32 1E-06
+
+// a block of matrices fills one register per element: 16 bytes on the baseline, 32 with avx2 and 64 with avx512
+#define BATCH_TYPES(bytes)                                                      \
+    typedef fdouble batch_vec##bytes __attribute__((vector_size(bytes)));      \
+    typedef long long batch_mask##bytes __attribute__((vector_size(bytes)));   \
+    typedef float batch_vec##bytes##_f32 __attribute__((vector_size(bytes)));  \
+    typedef int batch_mask##bytes##_f32 __attribute__((vector_size(bytes)));
+BATCH_TYPES(16)
+BATCH_TYPES(32)
+BATCH_TYPES(64)
+#undef BATCH_TYPES
+
+enum batch_op
+{
+    BATCH_DET,
+    BATCH_INV,
+    BATCH_PROD,
+    BATCH_SOLVE
+};
+
+// one batched operation over the stacks A, B and OUT of `count` matrices
+struct batch
+{
+    enum batch_op op;
+    lgint count;
+    // A(n, n) and B(n, k) for the factorizations, A(m, k) and B(k, n) for the product
+    lgint m, k, n;
+    cml_matrix *a, *b, *out;
+};
+
+#define BATCH_T fdouble
+#define BATCH_VEC batch_vec16
+#define BATCH_MASK batch_mask16
+#define BATCH_LANES 2
+#define BATCH_TOLERANCE BATCH_TOLERANCE_F64
+#define BATCH_TARGET
+#define BATCH_FN(name) batch_##name##_scalar
+#include "cml_batch_kernels.inc"
+
+#define BATCH_T float
+#define BATCH_VEC batch_vec16_f32
+#define BATCH_MASK batch_mask16_f32
+#define BATCH_LANES 4
+#define BATCH_TOLERANCE BATCH_TOLERANCE_F32
+#define BATCH_TARGET
+#define BATCH_FN(name) batch_##name##_scalar_f32
+#include "cml_batch_kernels.inc"
+
+#ifdef CML_BATCH_X86
+
+#define BATCH_T fdouble
+#define BATCH_VEC batch_vec32
+#define BATCH_MASK batch_mask32
+#define BATCH_LANES 4
+#define BATCH_TOLERANCE BATCH_TOLERANCE_F64
+#define BATCH_TARGET __attribute__((target("avx2")))
+#define BATCH_FN(name) batch_##name##_avx2
+#include "cml_batch_kernels.inc"
+
+#define BATCH_T float
+#define BATCH_VEC batch_vec32_f32
+#define BATCH_MASK batch_mask32_f32
+#define BATCH_LANES 8
+#define BATCH_TOLERANCE BATCH_TOLERANCE_F32
+#define BATCH_TARGET __attribute__((target("avx2")))
+#define BATCH_FN(name) batch_##name##_avx2_f32
+#include "cml_batch_kernels.inc"
+
+#define BATCH_T fdouble
+#define BATCH_VEC batch_vec64
+#define BATCH_MASK batch_mask64
+#define BATCH_LANES 8
+#define BATCH_TOLERANCE BATCH_TOLERANCE_F64
+#define BATCH_TARGET __attribute__((target("avx512f")))
+#define BATCH_FN(name) batch_##name##_avx512
+#include "cml_batch_kernels.inc"
+
+#define BATCH_T float
+#define BATCH_VEC batch_vec64_f32
+#define BATCH_MASK batch_mask64_f32
+#define BATCH_LANES 16
+#define BATCH_TOLERANCE BATCH_TOLERANCE_F32
+#define BATCH_TARGET __attribute__((target("avx512f")))
+#define BATCH_FN(name) batch_##name##_avx512_f32
+#include "cml_batch_kernels.inc"
+
+#endif
+
+struct batch_kernels
+{
+    cml_pool_task *task;
+    cml_pool_task *task_f32;
+    // double matrices per block, twice as many for float
+    lgint lanes;
+};
+
+static struct batch_kernels batch_kernels = {&batch_task_scalar, &batch_task_scalar_f32, 2};
+static pthread_once_t batch_once = PTHREAD_ONCE_INIT;
+
+// follow the instruction set chosen for the vector kernels, see cml_simd_name
+static void batch_init(void)
+{
+#ifdef CML_BATCH_X86
+    const char *name = cml_simd_name();
+    if (strcmp(name, "avx512") == 0)
+    {
+        batch_kernels.task = &batch_task_avx512;
+        batch_kernels.task_f32 = &batch_task_avx512_f32;
+        batch_kernels.lanes = 8;
+    }
+    else if (strcmp(name, "avx2") == 0)
+    {
+        batch_kernels.task = &batch_task_avx2;
+        batch_kernels.task_f32 = &batch_task_avx2_f32;
+        batch_kernels.lanes = 4;
+    }
+#endif
+}
+
+// whether the stack X holds `count` matrices of `size` elements of the given type
+static bool batch_check(cml_matrix *const x, const lgint count, const lgint size, const cml_dtype dtype)
+{
+    return x != NULL && x->m == count && x->n == size && x->dtype == dtype;
+}
+
+static cml_matrix *batch_run(struct batch *job, const lgint flops)
+{
+    if (job->count == 0)
+        return job->out;
+    if (matrix_unshare(job->out, job->out == job->a || job->out == job->b) == NULL)
+        return NULL;
+    pthread_once(&batch_once, &batch_init);
+    const lgint lanes = batch_kernels.lanes * ((job->a->dtype == FLOAT32) ? 2 : 1);
+    const lgint blocks = (job->count + lanes - 1) / lanes;
+    cml_pool_run(blocks, 1 + BATCH_GRAIN / (lanes * flops),
+                 (job->a->dtype == FLOAT32) ? batch_kernels.task_f32 : batch_kernels.task, job);
+    return job->out;
+}
+
+cml_matrix *cml_batch_det(const lgint n, cml_matrix *const a, cml_matrix *out)
+{
+    if (a == NULL || n == 0 || n > CML_BATCH_MAX_N || a->n != n * n || !batch_check(out, a->m, 1, a->dtype))
+    {
+        fprintf(stderr, "error (cml_batch_det): A should be a stack of (n, n) matrices with n <= %d, and OUT a column of as many elements of its type.\n", CML_BATCH_MAX_N);
+        return NULL;
+    }
+    struct batch job = {BATCH_DET, a->m, n, 0, n, a, NULL, out};
+    return batch_run(&job, n * n * n / 3 + 1);
+}
+
+cml_matrix *cml_batch_inv(const lgint n, cml_matrix *const a, cml_matrix *out)
+{
+    if (a == NULL || n == 0 || n > CML_BATCH_MAX_N || a->n != n * n || !batch_check(out, a->m, n * n, a->dtype))
+    {
+        fprintf(stderr, "error (cml_batch_inv): A and OUT should be stacks of as many (n, n) matrices of the same type, with n <= %d.\n", CML_BATCH_MAX_N);
+        return NULL;
+    }
+    struct batch job = {BATCH_INV, a->m, n, n, n, a, NULL, out};
+    return batch_run(&job, n * n * n);
+}
+
+cml_matrix *cml_batch_prod(const lgint m, const lgint k, const lgint n, cml_matrix *const a, cml_matrix *const b, cml_matrix *out)
+{
+    if (a == NULL || m == 0 || k == 0 || n == 0 || m > CML_BATCH_MAX_N || k > CML_BATCH_MAX_N || n > CML_BATCH_MAX_N ||
+        a->n != m * k || !batch_check(b, a->m, k * n, a->dtype) || !batch_check(out, a->m, m * n, a->dtype))
+    {
+        fprintf(stderr, "error (cml_batch_prod): A, B and OUT should be stacks of as many (m, k), (k, n) and (m, n) matrices of the same type, with m, k, n <= %d.\n", CML_BATCH_MAX_N);
+        return NULL;
+    }
+    struct batch job = {BATCH_PROD, a->m, m, k, n, a, b, out};
+    return batch_run(&job, m * k * n);
+}
+
+cml_matrix *cml_batch_solve(const lgint n, const lgint k, cml_matrix *const a, cml_matrix *const b, cml_matrix *out)
+{
+    if (a == NULL || n == 0 || k == 0 || n > CML_BATCH_MAX_N || k > CML_BATCH_MAX_N || a->n != n * n ||
+        !batch_check(b, a->m, n * k, a->dtype) || !batch_check(out, a->m, n * k, a->dtype))
+    {
+        fprintf(stderr, "error (cml_batch_solve): A, B and OUT should be stacks of as many (n, n), (n, k) and (n, k) matrices of the same type, with n, k <= %d.\n", CML_BATCH_MAX_N);
+        return NULL;
+    }
+    struct batch job = {BATCH_SOLVE, a->m, n, k, n, a, b, out};
+    return batch_run(&job, n * n * (n / 3 + k) + 1);
+}
@@ -0,0 +1,99 @@
+#include "cml_cholesky.h"
+#include "cml_gemm.h"
+#include "cml_trsm.h"
+
+#include <math.h>
+
+// number of columns factored per panel before the trailing update
+#define CHOLESKY_BLOCK 128
+
+// rows of C computed by one product, at most SYRK_BLOCK and at least SYRK_MIN_BLOCK,
+// fewer rows waste fewer multiply-adds below the diagonal
+#define SYRK_BLOCK 128
+#define SYRK_MIN_BLOCK 16
+
+// unblocked A = U^T*U on the upper triangle of the (n, n) block A
+static bool cholesky_block(const lgint n, fdouble *a, const lgint lda)
+{
+    for (lgint j = 0; j < n; j++)
+    {
+        fdouble *rj = a + j * lda;
+        if (!(rj[j] > 0.))
+            return false;
+        rj[j] = sqrt(rj[j]);
+        const fdouble inv = 1. / rj[j];
+        for (lgint c = j + 1; c < n; c++)
+        {
+            rj[c] *= inv;
+        }
+        for (lgint i = j + 1; i < n; i++)
+        {
+            fdouble *ri = a + i * lda;
+            const fdouble u = rj[i];
+            for (lgint c = i; c < n; c++)
+            {
+                ri[c] -= u * rj[c];
+            }
+        }
+    }
+    return true;
+}
+
+bool cml_cholesky(const lgint n, fdouble *a, const lgint lda)
+{
+    for (lgint k = 0; k < n; k += CHOLESKY_BLOCK)
+    {
+        const lgint kb = (n - k < CHOLESKY_BLOCK) ? n - k : CHOLESKY_BLOCK;
+        fdouble *a11 = a + k * lda + k;
+        if (!cholesky_block(kb, a11, lda))
+            return false;
+
+        const lgint rest = n - k - kb;
+        if (rest == 0)
+            break;
+
+        // U12 <= U11^-T*A12, then A22 <= A22 - U12^T*U12 on its upper triangle
+        fdouble *a12 = a11 + kb;
+        cml_trsm(true, true, false, kb, rest, a11, lda, a12, lda);
+        cml_syrk(rest, kb, -1., a12, lda, 1., a + (k + kb) * lda + k + kb, lda);
+    }
+    return true;
+}
+
+// rows of C per product, a quarter of them for the narrow C
+static lgint syrk_block(const lgint n)
+{
+    lgint b = (n / 4 + 7) / 8 * 8;
+    if (b < SYRK_MIN_BLOCK)
+        b = SYRK_MIN_BLOCK;
+    return (b < SYRK_BLOCK) ? b : SYRK_BLOCK;
+}
+
+void cml_syrk(const lgint n, const lgint k, const fdouble alpha, const fdouble *a, const lgint lda,
+              const fdouble beta, fdouble *c, const lgint ldc)
+{
+    const lgint block = syrk_block(n);
+    for (lgint i0 = 0; i0 < n; i0 += block)
+    {
+        const lgint ib = (n - i0 < block) ? n - i0 : block;
+        // blocks right of the diagonal block in a single product, their rows are contiguous
+        cml_gemm(true, false, ib, n - i0, k,
+                 alpha, a + i0, lda,
+                 a + i0, lda,
+                 beta, c + i0 * ldc + i0, ldc);
+    }
+}
+
+void cml_syrk_f32(const lgint n, const lgint k, const float alpha, const float *a, const lgint lda,
+                  const float beta, float *c, const lgint ldc)
+{
+    const lgint block = syrk_block(n);
+    for (lgint i0 = 0; i0 < n; i0 += block)
+    {
+        const lgint ib = (n - i0 < block) ? n - i0 : block;
+        cml_gemm_f32(true, false, ib, n - i0, k,
+                     alpha, a + i0, lda,
+                     a + i0, lda,
+                     beta, c + i0 * ldc + i0, ldc);
+    }
+}
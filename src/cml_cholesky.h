@@ -0,0 +1,22 @@
+#ifndef cml_cholesky_h
+#define cml_cholesky_h
+
+#include "cml_matrix.h"
+
+#include <stdbool.h>
+
+// A(n, n) <= U in place with A = U^T*U and U upper triangular, only the upper
+// triangle of A is read and written. Returns false when A is not positive
+// definite, A is then left partially factored.
+bool cml_cholesky(const lgint n, fdouble *a, const lgint lda);
+
+// upper triangle of C(n, n) <= alpha*A^T*A + beta*C for A(k, n), about half
+// the multiply-adds of the full product. The elements below the diagonal are
+// left undefined near the diagonal and untouched further away.
+void cml_syrk(const lgint n, const lgint k, const fdouble alpha, const fdouble *a, const lgint lda,
+              const fdouble beta, fdouble *c, const lgint ldc);
+
+void cml_syrk_f32(const lgint n, const lgint k, const float alpha, const float *a, const lgint lda,
+                  const float beta, float *c, const lgint ldc);
+
+#endif
@@ -1,4 +1,5 @@
 #include "cml_data.h"
+#include "cml_matrix_impl.h"
 
 #include <limits.h>
 #include <stdio.h>
@@ -34,7 +35,7 @@ void cml_data_read(cml_matrix **x, cml_matrix **y, const char *file_path, const
         token = strtok(dummy, delimiter);
         value = strtod(token, NULL);
 
-        (*x)->set(x, i, j, value);
+        matrix_store(*x, i, j, value);
         j++;
 
         while (token != NULL)
@@ -47,11 +48,11 @@ void cml_data_read(cml_matrix **x, cml_matrix **y, const char *file_path, const
 
             if (j < (*x)->n)
             {
-                (*x)->set(x, i, j, value);
+                matrix_store(*x, i, j, value);
             }
             else
             {
-                (*y)->set(y, i, j - (*x)->n, value);
+                matrix_store(*y, i, j - (*x)->n, value);
             }
 
             j++;
@@ -93,6 +94,22 @@ static void sufle_indices(lgint *indices, const lgint max)
     }
 }
 
+// copy the rows indices[0], ..., indices[m - 1] of A into a new matrix, NULL when the allocation has failed
+static cml_matrix *data_gather(cml_matrix *const a, const lgint *indices, const lgint m)
+{
+    cml_matrix *out = cml_matrix_alloc_dtype(m, a->n, a->dtype);
+    if (out == NULL)
+    {
+        fprintf(stderr, "error (cml_data_split): the allocation memory of a shuffled part has failed.\n");
+        return NULL;
+    }
+    for (lgint i = 0; i < m; i++)
+    {
+        memcpy(matrix_ptr(out, i, 0), matrix_ptr(a, indices[i], 0), a->n * matrix_elsize(a));
+    }
+    return out;
+}
+
 void cml_data_split(
     cml_matrix **train_data_x, cml_matrix **train_data_y,
     cml_matrix **val_data_x, cml_matrix **val_data_y,
@@ -114,60 +131,38 @@ void cml_data_split(
     const lgint test_size = test_percentage * x->m;
     const lgint train_size = x->m - (val_size + test_size);
 
-    *train_data_x = cml_matrix_alloc(train_size, x->n);
-    *train_data_y = cml_matrix_alloc(train_size, y->n);
+    if (!shuffle)
+    {
+        // the parts are consecutive row ranges, viewed in place
+        *train_data_x = cml_matrix_view_rows(x, 0, train_size);
+        *train_data_y = cml_matrix_view_rows(y, 0, train_size);
 
-    *val_data_x = cml_matrix_alloc(val_size, x->n);
-    *val_data_y = cml_matrix_alloc(val_size, y->n);
+        *val_data_x = cml_matrix_view_rows(x, train_size, val_size);
+        *val_data_y = cml_matrix_view_rows(y, train_size, val_size);
 
-    *test_data_x = cml_matrix_alloc(test_size, x->n);
-    *test_data_y = cml_matrix_alloc(test_size, y->n);
+        *test_data_x = cml_matrix_view_rows(x, train_size + val_size, test_size);
+        *test_data_y = cml_matrix_view_rows(y, train_size + val_size, test_size);
+        return;
+    }
 
     lgint indices[x->m];
-    if (shuffle)
-    {
-        sufle_indices(indices, x->m);
-    }
-    else
-    {
-        for (lgint i = 0; i < x->m; i++)
-            indices[i] = i;
-    }
+    sufle_indices(indices, x->m);
 
-    for (lgint i = 0; i < x->m; i++)
+    // X and Y parts, gathered in this order from the shuffled rows
+    cml_matrix **parts[6] = {train_data_x, train_data_y, val_data_x, val_data_y, test_data_x, test_data_y};
+    const lgint first[3] = {0, train_size, train_size + val_size};
+    const lgint size[3] = {train_size, val_size, test_size};
+    for (int p = 0; p < 6; p++)
     {
-        if (i >= train_size + val_size)
-        {
-            for (lgint j = 0; j < x->n; j++)
-            {
-                (*test_data_x)->set(test_data_x, i - val_size - train_size, j, x->get(x, indices[i], j));
-            }
-            for (lgint j = 0; j < y->n; j++)
-            {
-                (*test_data_y)->set(test_data_y, i - val_size - train_size, j, y->get(y, indices[i], j));
-            }
-        }
-        else if (i >= train_size)
-        {
-            for (lgint j = 0; j < x->n; j++)
-            {
-                (*val_data_x)->set(val_data_x, i - train_size, j, x->get(x, indices[i], j));
-            }
-            for (lgint j = 0; j < y->n; j++)
-            {
-                (*val_data_y)->set(val_data_y, i - train_size, j, y->get(y, indices[i], j));
-            }
-        }
-        else
+        *parts[p] = data_gather((p % 2 == 0) ? x : y, indices + first[p / 2], size[p / 2]);
+        if (*parts[p] != NULL)
+            continue;
+
+        // all parts or none: the parts gathered so far are freed
+        for (int q = 0; q < p; q++)
         {
-            for (lgint j = 0; j < x->n; j++)
-            {
-                (*train_data_x)->set(train_data_x, i, j, x->get(x, indices[i], j));
-            }
-            for (lgint j = 0; j < y->n; j++)
-            {
-                (*train_data_y)->set(train_data_y, i, j, y->get(y, indices[i], j));
-            }
+            (*parts[q])->vt->free(parts[q]);
         }
+        return;
     }
-}
\ No newline at end of file
+}
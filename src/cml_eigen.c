@@ -0,0 +1,444 @@
+#include "cml_eigen.h"
+#include "cml_gemm.h"
+#include "cml_qr.h"
+#include "cml_simd.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// implicit QL iterations allowed for one eigenvalue before giving up
+#define EIGEN_MAX_ITERATIONS 64
+
+// columns sampled beyond the rank k, and power iterations refining them
+#define RSVD_OVERSAMPLING 10
+#define RSVD_POWER_ITERATIONS 4
+
+// sweeps of one-sided Jacobi rotations allowed on the projected matrix
+#define RSVD_MAX_SWEEPS 64
+
+// seed of the random test matrix, fixed so that the factorization is reproducible
+#define RSVD_SEED 0x9E3779B97F4A7C15ULL
+
+// Householder reduction of the symmetric V(n, n) to a tridiagonal matrix of
+// diagonal d and subdiagonal e[1:n], V <= the accumulated transformations
+static void eigen_tridiagonalize(const lgint n, fdouble *v, fdouble *d, fdouble *e)
+{
+    for (lgint j = 0; j < n; j++)
+    {
+        d[j] = v[(n - 1) * n + j];
+    }
+
+    for (lgint i = n - 1; i > 0; i--)
+    {
+        // scale to avoid under/overflow
+        fdouble scale = 0., h = 0.;
+        for (lgint k = 0; k < i; k++)
+        {
+            scale += fabs(d[k]);
+        }
+        if (scale == 0.)
+        {
+            e[i] = d[i - 1];
+            for (lgint j = 0; j < i; j++)
+            {
+                d[j] = v[(i - 1) * n + j];
+                v[i * n + j] = 0.;
+                v[j * n + i] = 0.;
+            }
+            d[i] = h;
+            continue;
+        }
+
+        // Householder vector
+        for (lgint k = 0; k < i; k++)
+        {
+            d[k] /= scale;
+            h += d[k] * d[k];
+        }
+        fdouble f = d[i - 1];
+        fdouble g = (f > 0.) ? -sqrt(h) : sqrt(h);
+        e[i] = scale * g;
+        h -= f * g;
+        d[i - 1] = f - g;
+        for (lgint j = 0; j < i; j++)
+        {
+            e[j] = 0.;
+        }
+
+        // similarity transformation of the remaining columns
+        for (lgint j = 0; j < i; j++)
+        {
+            f = d[j];
+            v[j * n + i] = f;
+            g = e[j] + v[j * n + j] * f;
+            for (lgint k = j + 1; k < i; k++)
+            {
+                g += v[k * n + j] * d[k];
+                e[k] += v[k * n + j] * f;
+            }
+            e[j] = g;
+        }
+        f = 0.;
+        for (lgint j = 0; j < i; j++)
+        {
+            e[j] /= h;
+            f += e[j] * d[j];
+        }
+        const fdouble hh = f / (h + h);
+        for (lgint j = 0; j < i; j++)
+        {
+            e[j] -= hh * d[j];
+        }
+        for (lgint j = 0; j < i; j++)
+        {
+            f = d[j];
+            g = e[j];
+            for (lgint k = j; k < i; k++)
+            {
+                v[k * n + j] -= (f * e[k] + g * d[k]);
+            }
+            d[j] = v[(i - 1) * n + j];
+            v[i * n + j] = 0.;
+        }
+        d[i] = h;
+    }
+
+    // accumulate the transformations
+    for (lgint i = 0; i + 1 < n; i++)
+    {
+        v[(n - 1) * n + i] = v[i * n + i];
+        v[i * n + i] = 1.;
+        const fdouble h = d[i + 1];
+        if (h != 0.)
+        {
+            for (lgint k = 0; k <= i; k++)
+            {
+                d[k] = v[k * n + i + 1] / h;
+            }
+            for (lgint j = 0; j <= i; j++)
+            {
+                fdouble g = 0.;
+                for (lgint k = 0; k <= i; k++)
+                {
+                    g += v[k * n + i + 1] * v[k * n + j];
+                }
+                for (lgint k = 0; k <= i; k++)
+                {
+                    v[k * n + j] -= g * d[k];
+                }
+            }
+        }
+        for (lgint k = 0; k <= i; k++)
+        {
+            v[k * n + i + 1] = 0.;
+        }
+    }
+    for (lgint j = 0; j < n; j++)
+    {
+        d[j] = v[(n - 1) * n + j];
+        v[(n - 1) * n + j] = 0.;
+    }
+    v[(n - 1) * n + n - 1] = 1.;
+    e[0] = 0.;
+}
+
+// implicit QL iterations on the tridiagonal matrix (d, e[1:n]), d <= the
+// eigenvalues and the rows of Z(n, n) rotated into the eigenvectors
+static bool eigen_diagonalize(const lgint n, fdouble *d, fdouble *e, fdouble *z, const lgint ldz)
+{
+    for (lgint i = 1; i < n; i++)
+    {
+        e[i - 1] = e[i];
+    }
+    e[n - 1] = 0.;
+
+    fdouble f = 0., tst1 = 0.;
+    for (lgint l = 0; l < n; l++)
+    {
+        // small subdiagonal element splitting the matrix
+        tst1 = fmax(tst1, fabs(d[l]) + fabs(e[l]));
+        lgint m = l;
+        while (m < n - 1 && fabs(e[m]) > DBL_EPSILON * tst1)
+        {
+            m++;
+        }
+
+        for (int iteration = 0; m > l && fabs(e[l]) > DBL_EPSILON * tst1; iteration++)
+        {
+            if (iteration == EIGEN_MAX_ITERATIONS)
+                return false;
+
+            // implicit shift
+            fdouble g = d[l];
+            fdouble p = (d[l + 1] - g) / (2. * e[l]);
+            fdouble r = (p < 0.) ? -hypot(p, 1.) : hypot(p, 1.);
+            d[l] = e[l] / (p + r);
+            d[l + 1] = e[l] * (p + r);
+            const fdouble dl1 = d[l + 1];
+            fdouble h = g - d[l];
+            for (lgint i = l + 2; i < n; i++)
+            {
+                d[i] -= h;
+            }
+            f += h;
+
+            // QL sweep from m back to l
+            p = d[m];
+            fdouble c = 1., c2 = 1., c3 = 1., s = 0., s2 = 0.;
+            const fdouble el1 = e[l + 1];
+            for (lgint i = m; i-- > l;)
+            {
+                c3 = c2;
+                c2 = c;
+                s2 = s;
+                g = c * e[i];
+                h = c * p;
+                r = hypot(p, e[i]);
+                e[i + 1] = s * r;
+                s = e[i] / r;
+                c = p / r;
+                p = c * d[i] - s * g;
+                d[i + 1] = h + s * (c * g + s * d[i]);
+
+                // rows i and i + 1 of Z
+                fdouble *zi = z + i * ldz, *zj = zi + ldz;
+                for (lgint k = 0; k < n; k++)
+                {
+                    h = zj[k];
+                    zj[k] = s * zi[k] + c * h;
+                    zi[k] = c * zi[k] - s * h;
+                }
+            }
+            p = -s * s2 * c3 * el1 * e[l] / dl1;
+            e[l] = s * p;
+            d[l] = c * p;
+        }
+        d[l] += f;
+        e[l] = 0.;
+    }
+    return true;
+}
+
+bool cml_syev(const lgint n, fdouble *a, const lgint lda, fdouble *w)
+{
+    if (n == 0)
+        return true;
+    fdouble *v = (fdouble *)malloc((n * n + n) * sizeof(*v));
+    if (v == NULL)
+        return false;
+    fdouble *e = v + n * n;
+    for (lgint i = 0; i < n; i++)
+    {
+        memcpy(v + i * n, a + i * lda, n * sizeof(*v));
+    }
+
+    // the eigenvectors are the columns of V, rotated as the rows of V^T
+    eigen_tridiagonalize(n, v, w, e);
+    for (lgint i = 0; i < n; i++)
+    {
+        for (lgint j = 0; j < n; j++)
+        {
+            a[i * lda + j] = v[j * n + i];
+        }
+    }
+    const bool converged = eigen_diagonalize(n, w, e, a, lda);
+    free(v);
+    if (!converged)
+        return false;
+
+    // decreasing eigenvalues, by selection
+    for (lgint i = 0; i + 1 < n; i++)
+    {
+        lgint best = i;
+        for (lgint j = i + 1; j < n; j++)
+        {
+            if (w[j] > w[best])
+                best = j;
+        }
+        if (best == i)
+            continue;
+        const fdouble t = w[i];
+        w[i] = w[best];
+        w[best] = t;
+        fdouble *ri = a + i * lda, *rb = a + best * lda;
+        for (lgint j = 0; j < n; j++)
+        {
+            const fdouble x = ri[j];
+            ri[j] = rb[j];
+            rb[j] = x;
+        }
+    }
+    return true;
+}
+
+// standard normal number from the splitmix64 generator of state `state`
+static fdouble rsvd_normal(uint64_t *state)
+{
+    fdouble u[2];
+    for (int t = 0; t < 2; t++)
+    {
+        uint64_t x = (*state += 0x9E3779B97F4A7C15ULL);
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        // in (0, 1]
+        u[t] = ((x >> 11) + 1) * (1. / 9007199254740992.);
+    }
+    return sqrt(-2. * log(u[0])) * cos(2. * M_PI * u[1]);
+}
+
+// Y(m, l) <= an orthonormal basis of its columns, with the workspace `w` of at least l + m*l values
+static bool rsvd_orthonormalize(const lgint m, const lgint l, fdouble *y, fdouble *w)
+{
+    fdouble *tau = w, *q = w + l;
+    if (!cml_qr(m, l, y, l, tau))
+        return false;
+    memset(q, 0, m * l * sizeof(*q));
+    for (lgint i = 0; i < l; i++)
+    {
+        q[i * l + i] = 1.;
+    }
+    if (!cml_qr_apply(false, m, l, l, y, l, tau, q, l))
+        return false;
+    memcpy(y, q, m * l * sizeof(*y));
+    return true;
+}
+
+// rows of B(l, n) <= G*B orthogonal by one-sided Jacobi rotations, which are
+// accumulated in the rows of G(l, l)
+static void rsvd_jacobi(const lgint l, const lgint n, fdouble *b, fdouble *g)
+{
+    for (int sweep = 0; sweep < RSVD_MAX_SWEEPS; sweep++)
+    {
+        bool rotated = false;
+        for (lgint p = 0; p + 1 < l; p++)
+        {
+            for (lgint q = p + 1; q < l; q++)
+            {
+                fdouble *bp = b + p * n, *bq = b + q * n;
+                const fdouble alpha = cml_vec_dot(n, bp, bp);
+                const fdouble beta = cml_vec_dot(n, bq, bq);
+                const fdouble gamma = cml_vec_dot(n, bp, bq);
+                if (fabs(gamma) <= DBL_EPSILON * sqrt(alpha * beta))
+                    continue;
+                rotated = true;
+
+                // rotation zeroing the product of the rows p and q
+                const fdouble zeta = (beta - alpha) / (2. * gamma);
+                const fdouble t = ((zeta >= 0.) ? 1. : -1.) / (fabs(zeta) + sqrt(1. + zeta * zeta));
+                const fdouble c = 1. / sqrt(1. + t * t), s = c * t;
+                for (lgint j = 0; j < n; j++)
+                {
+                    const fdouble x = bp[j];
+                    bp[j] = c * x - s * bq[j];
+                    bq[j] = s * x + c * bq[j];
+                }
+                fdouble *gp = g + p * l, *gq = g + q * l;
+                for (lgint j = 0; j < l; j++)
+                {
+                    const fdouble x = gp[j];
+                    gp[j] = c * x - s * gq[j];
+                    gq[j] = s * x + c * gq[j];
+                }
+            }
+        }
+        if (!rotated)
+            break;
+    }
+}
+
+bool cml_rsvd(const lgint m, const lgint n, const lgint k, const fdouble *a, const lgint lda,
+              fdouble *u, fdouble *s, fdouble *vt)
+{
+    if (k == 0)
+        return true;
+    const lgint r = (m < n) ? m : n;
+    const lgint l = (k + RSVD_OVERSAMPLING < r) ? k + RSVD_OVERSAMPLING : r;
+    // the bases are (m, l) and (n, l)
+    const lgint mn = (m > n) ? m : n;
+
+    // Z(n, l), then B(l, n), Y(m, l), G(l, l), the norms of the rows of B and the workspace of the bases
+    fdouble *z = (fdouble *)malloc((n * l + m * l + l * l + l + l + mn * l) * sizeof(*z));
+    lgint *order = (lgint *)malloc(l * sizeof(*order));
+    if (z == NULL || order == NULL)
+    {
+        free(z);
+        free(order);
+        return false;
+    }
+    fdouble *y = z + n * l, *g = y + m * l, *norm = g + l * l, *w = norm + l;
+
+    // Y = A*Omega for the gaussian Omega(n, l), kept in Z
+    uint64_t state = RSVD_SEED;
+    for (lgint i = 0; i < n * l; i++)
+    {
+        z[i] = rsvd_normal(&state);
+    }
+    cml_gemm(false, false, m, l, n, 1., a, lda, z, l, 0., y, l);
+
+    // power iterations Y = A*A^T*Y, orthonormalized at each step to keep the small singular values
+    bool ok = true;
+    for (int t = 0; ok && t < RSVD_POWER_ITERATIONS; t++)
+    {
+        ok = rsvd_orthonormalize(m, l, y, w);
+        cml_gemm(true, false, n, l, m, 1., a, lda, y, l, 0., z, l);
+        ok = ok && rsvd_orthonormalize(n, l, z, w);
+        cml_gemm(false, false, m, l, n, 1., a, lda, z, l, 0., y, l);
+    }
+    ok = ok && rsvd_orthonormalize(m, l, y, w);
+    if (!ok)
+    {
+        free(z);
+        free(order);
+        return false;
+    }
+
+    // A ~ Q*B with B = Q^T*A (l, n) in Z, B = G^T*diag(s)*V^T once the rows of G*B are orthogonal
+    fdouble *b = z;
+    cml_gemm(true, false, l, n, m, 1., y, l, a, lda, 0., b, n);
+    memset(g, 0, l * l * sizeof(*g));
+    for (lgint i = 0; i < l; i++)
+    {
+        g[i * l + i] = 1.;
+    }
+    rsvd_jacobi(l, n, b, g);
+
+    // the k largest singular values, the norms of the rows of B
+    for (lgint i = 0; i < l; i++)
+    {
+        norm[i] = sqrt(cml_vec_dot(n, b + i * n, b + i * n));
+        order[i] = i;
+    }
+    for (lgint i = 0; i < k; i++)
+    {
+        lgint best = i;
+        for (lgint j = i + 1; j < l; j++)
+        {
+            if (norm[order[j]] > norm[order[best]])
+                best = j;
+        }
+        const lgint t = order[i];
+        order[i] = order[best];
+        order[best] = t;
+    }
+    for (lgint i = 0; i < k; i++)
+    {
+        const lgint p = order[i];
+        s[i] = norm[p];
+        cml_vec_scale(n, (norm[p] > 0.) ? 1. / norm[p] : 0., b + p * n, vt + i * n);
+        // rows of G kept in W for U = Q*G_k^T
+        memcpy(w + i * l, g + p * l, l * sizeof(*w));
+    }
+    cml_gemm(false, true, m, k, l, 1., y, l, w, l, 0., u, k);
+
+    free(z);
+    free(order);
+    return true;
+}
@@ -0,0 +1,23 @@
+#ifndef cml_eigen_h
+#define cml_eigen_h
+
+#include "cml_matrix.h"
+
+#include <stdbool.h>
+
+// eigenvalues w (n) of the symmetric A(n, n) in decreasing order, and A <=
+// the orthonormal eigenvectors in its rows, row i going with w[i]. A is
+// reduced to a tridiagonal matrix by Householder reflections, then
+// diagonalized by implicit QL iterations. Returns false when the workspace
+// cannot be allocated or an eigenvalue does not converge.
+bool cml_syev(const lgint n, fdouble *a, const lgint lda, fdouble *w);
+
+// truncated SVD A(m, n) ~ U*diag(s)*V^T of rank k <= min(m, n): U(m, k),
+// s (k) decreasing and the rows of V^T in vt(k, n), all with leading
+// dimensions k, 1 and n. A is only read through products, the range of A
+// being sampled by a random test matrix refined by power iterations.
+// Returns false when the workspace cannot be allocated.
+bool cml_rsvd(const lgint m, const lgint n, const lgint k, const fdouble *a, const lgint lda,
+              fdouble *u, fdouble *s, fdouble *vt);
+
+#endif
@@ -0,0 +1,228 @@
+#include "cml_gemm.h"
+#include "cml_activation_impl.h"
+#include "cml_pool.h"
+#include "cml_simd.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CML_GEMM_X86 1
+#endif
+
+// cache blocking: a MC x KC block of A stays in L2, a KC x NR sliver of B in L1
+#define GEMM_MC 128
+#define GEMM_KC 256
+#define GEMM_NC 4096
+
+// below this number of multiply-adds, packing costs more than it saves
+#define GEMM_SMALL 4096
+
+// below this number of multiply-adds, the product runs on the calling thread only
+#define GEMM_PARALLEL 262144
+
+// number of elements below which the epilogue alone runs on a single thread
+#define GEMM_EPILOGUE_GRAIN 4096
+
+#define GEMM_MIN(a, b) ((a) < (b) ? (a) : (b))
+
+#define GEMM_STR(x) #x
+#define GEMM_XSTR(x) GEMM_STR(x)
+
+// offset of the element (i, j) of op(X) in the row-major storage of X
+static inline lgint gemm_offset(const bool trans, const lgint i, const lgint j, const lgint ld)
+{
+    return trans ? j * ld + i : i * ld + j;
+}
+
+// packing buffer of A, owned by each thread, grown on demand and freed when the thread exits
+static __thread void *gemm_pa = NULL;
+static __thread size_t gemm_pa_size = 0;
+static pthread_key_t gemm_pa_key;
+static pthread_once_t gemm_pa_once = PTHREAD_ONCE_INIT;
+
+static void gemm_pa_init(void)
+{
+    pthread_key_create(&gemm_pa_key, &free);
+}
+
+// at least `size` bytes, NULL when the allocation has failed
+static void *gemm_pack_a_buffer(const size_t size)
+{
+    if (size > gemm_pa_size)
+    {
+        pthread_once(&gemm_pa_once, &gemm_pa_init);
+        void *pa = realloc(gemm_pa, size);
+        if (pa == NULL)
+            return NULL;
+        gemm_pa = pa;
+        gemm_pa_size = size;
+        // the key owns the buffer, its destructor frees it at the exit of the thread
+        pthread_setspecific(gemm_pa_key, pa);
+    }
+    return gemm_pa;
+}
+
+// the register tile (GEMM_MR, GEMM_NR) of each instance is sized for its
+// register file: the accumulators take 8 of the 16 registers on the baseline
+// and with avx2, 24 of the 32 with avx512, the sliver of B and the broadcast
+// element of A most of the others
+#define GEMM_T fdouble
+#define GEMM_MR 4
+#define GEMM_NR 4
+#define GEMM_LANES 2
+#define GEMM_TARGET
+#define GEMM_FN(name) name##_f64
+#define GEMM_NAME cml_gemm
+#include "cml_gemm_kernels.inc"
+
+#define GEMM_T float
+#define GEMM_MR 4
+#define GEMM_NR 8
+#define GEMM_LANES 4
+#define GEMM_TARGET
+#define GEMM_FN(name) name##_f32
+#define GEMM_NAME cml_gemm_f32
+#include "cml_gemm_kernels.inc"
+
+#ifdef CML_GEMM_X86
+
+#define GEMM_T fdouble
+#define GEMM_MR 4
+#define GEMM_NR 8
+#define GEMM_LANES 4
+#define GEMM_TARGET __attribute__((target("avx2,fma")))
+#define GEMM_FN(name) name##_f64_avx2
+#define GEMM_NAME cml_gemm
+#include "cml_gemm_kernels.inc"
+
+#define GEMM_T float
+#define GEMM_MR 4
+#define GEMM_NR 16
+#define GEMM_LANES 8
+#define GEMM_TARGET __attribute__((target("avx2,fma")))
+#define GEMM_FN(name) name##_f32_avx2
+#define GEMM_NAME cml_gemm_f32
+#include "cml_gemm_kernels.inc"
+
+#define GEMM_T fdouble
+#define GEMM_MR 8
+#define GEMM_NR 24
+#define GEMM_LANES 8
+#define GEMM_TARGET __attribute__((target("avx512f")))
+#define GEMM_FN(name) name##_f64_avx512
+#define GEMM_NAME cml_gemm
+#include "cml_gemm_kernels.inc"
+
+#define GEMM_T float
+#define GEMM_MR 8
+#define GEMM_NR 48
+#define GEMM_LANES 16
+#define GEMM_TARGET __attribute__((target("avx512f")))
+#define GEMM_FN(name) name##_f32_avx512
+#define GEMM_NAME cml_gemm_f32
+#include "cml_gemm_kernels.inc"
+
+#endif
+
+// the product followed by an optional epilogue, and the epilogue alone
+typedef void gemm_run_kernel(const bool trans_a, const bool trans_b, const lgint m, const lgint n, const lgint k,
+                             const fdouble alpha, const fdouble *a, const lgint lda, const fdouble *b, const lgint ldb,
+                             const fdouble beta, const struct cml_gemm_epilogue *ep, fdouble *c, const lgint ldc);
+typedef void gemm_run_kernel_f32(const bool trans_a, const bool trans_b, const lgint m, const lgint n, const lgint k,
+                                 const float alpha, const float *a, const lgint lda, const float *b, const lgint ldb,
+                                 const float beta, const struct cml_gemm_epilogue *ep, float *c, const lgint ldc);
+typedef void gemm_epilogue_kernel(const struct cml_gemm_epilogue *ep, const lgint m, const lgint n, fdouble *c, const lgint ldc);
+typedef void gemm_epilogue_kernel_f32(const struct cml_gemm_epilogue *ep, const lgint m, const lgint n, float *c, const lgint ldc);
+
+struct gemm_kernels
+{
+    gemm_run_kernel *run;
+    gemm_run_kernel_f32 *run_f32;
+    gemm_epilogue_kernel *epilogue;
+    gemm_epilogue_kernel_f32 *epilogue_f32;
+};
+
+static struct gemm_kernels gemm_kernels = {&gemm_run_f64, &gemm_run_f32, &gemm_epilogue_f64, &gemm_epilogue_f32};
+static pthread_once_t gemm_once = PTHREAD_ONCE_INIT;
+
+// follow the instruction set chosen for the vector kernels, see cml_simd_name,
+// the avx2 instances also needing fma
+static void gemm_init(void)
+{
+#ifdef CML_GEMM_X86
+    const char *name = cml_simd_name();
+    if (strcmp(name, "avx512") == 0)
+    {
+        gemm_kernels = (struct gemm_kernels){&gemm_run_f64_avx512, &gemm_run_f32_avx512,
+                                             &gemm_epilogue_f64_avx512, &gemm_epilogue_f32_avx512};
+    }
+    else if (strcmp(name, "avx2") == 0 && __builtin_cpu_supports("fma"))
+    {
+        gemm_kernels = (struct gemm_kernels){&gemm_run_f64_avx2, &gemm_run_f32_avx2,
+                                             &gemm_epilogue_f64_avx2, &gemm_epilogue_f32_avx2};
+    }
+#endif
+}
+
+static inline const struct gemm_kernels *gemm_select(void)
+{
+    pthread_once(&gemm_once, &gemm_init);
+    return &gemm_kernels;
+}
+
+void cml_gemm(const bool trans_a, const bool trans_b,
+              const lgint m, const lgint n, const lgint k,
+              const fdouble alpha,
+              const fdouble *a, const lgint lda,
+              const fdouble *b, const lgint ldb,
+              const fdouble beta,
+              fdouble *c, const lgint ldc)
+{
+    gemm_select()->run(trans_a, trans_b, m, n, k, alpha, a, lda, b, ldb, beta, NULL, c, ldc);
+}
+
+void cml_gemm_f32(const bool trans_a, const bool trans_b,
+                  const lgint m, const lgint n, const lgint k,
+                  const float alpha,
+                  const float *a, const lgint lda,
+                  const float *b, const lgint ldb,
+                  const float beta,
+                  float *c, const lgint ldc)
+{
+    gemm_select()->run_f32(trans_a, trans_b, m, n, k, alpha, a, lda, b, ldb, beta, NULL, c, ldc);
+}
+
+void cml_gemm_fused(const bool trans_a, const bool trans_b,
+                    const lgint m, const lgint n, const lgint k,
+                    const fdouble alpha,
+                    const fdouble *a, const lgint lda,
+                    const fdouble *b, const lgint ldb,
+                    const struct cml_gemm_epilogue *ep,
+                    fdouble *c, const lgint ldc)
+{
+    gemm_select()->run(trans_a, trans_b, m, n, k, alpha, a, lda, b, ldb, 0., ep, c, ldc);
+}
+
+void cml_gemm_fused_f32(const bool trans_a, const bool trans_b,
+                        const lgint m, const lgint n, const lgint k,
+                        const float alpha,
+                        const float *a, const lgint lda,
+                        const float *b, const lgint ldb,
+                        const struct cml_gemm_epilogue *ep,
+                        float *c, const lgint ldc)
+{
+    gemm_select()->run_f32(trans_a, trans_b, m, n, k, alpha, a, lda, b, ldb, 0., ep, c, ldc);
+}
+
+void cml_gemm_epilogue(const struct cml_gemm_epilogue *ep, const lgint m, const lgint n, fdouble *c, const lgint ldc)
+{
+    gemm_select()->epilogue(ep, m, n, c, ldc);
+}
+
+void cml_gemm_epilogue_f32(const struct cml_gemm_epilogue *ep, const lgint m, const lgint n, float *c, const lgint ldc)
+{
+    gemm_select()->epilogue_f32(ep, m, n, c, ldc);
+}
@@ -0,0 +1,69 @@
+#ifndef cml_gemm_h
+#define cml_gemm_h
+
+#include "cml_activation.h"
+#include "cml_matrix.h"
+
+#include <stdbool.h>
+
+// C <= alpha*op(A)*op(B) + beta*C with op(A)(m, k), op(B)(k, n) and C(m, n),
+// where op(X) is X^T when `trans_x` is set and X otherwise. The matrices are
+// row-major with leading dimensions `lda`, `ldb` and `ldc`, read in place
+// whatever the transposition. C is not read when beta = 0.
+void cml_gemm(const bool trans_a, const bool trans_b,
+              const lgint m, const lgint n, const lgint k,
+              const fdouble alpha,
+              const fdouble *a, const lgint lda,
+              const fdouble *b, const lgint ldb,
+              const fdouble beta,
+              fdouble *c, const lgint ldc);
+
+// single-precision GEMM, same conventions
+void cml_gemm_f32(const bool trans_a, const bool trans_b,
+                  const lgint m, const lgint n, const lgint k,
+                  const float alpha,
+                  const float *a, const lgint lda,
+                  const float *b, const lgint ldb,
+                  const float beta,
+                  float *c, const lgint ldc);
+
+// C <= f(C + bias) with the n elements of `bias` (of the type of C) added to
+// every row, where f is the activation or its derivative when `derivative`
+// is set. The value of SOFTMAX is then normalized over each row, not its
+// derivative. When `grad` is not NULL, the derivative is also stored there,
+// a matrix (m, n) of the type of C with rows `ldg` elements apart, from the
+// same sums as the value.
+struct cml_gemm_epilogue
+{
+    cml_activation activation;
+    bool derivative;
+    const void *bias;
+    void *grad;
+    lgint ldg;
+};
+
+// C <= f(alpha*op(A)*op(B) + bias), the epilogue being applied to each tile
+// of C right after its last rank-kc update, while it is still in cache,
+// rather than in a second pass over C
+void cml_gemm_fused(const bool trans_a, const bool trans_b,
+                    const lgint m, const lgint n, const lgint k,
+                    const fdouble alpha,
+                    const fdouble *a, const lgint lda,
+                    const fdouble *b, const lgint ldb,
+                    const struct cml_gemm_epilogue *ep,
+                    fdouble *c, const lgint ldc);
+
+void cml_gemm_fused_f32(const bool trans_a, const bool trans_b,
+                        const lgint m, const lgint n, const lgint k,
+                        const float alpha,
+                        const float *a, const lgint lda,
+                        const float *b, const lgint ldb,
+                        const struct cml_gemm_epilogue *ep,
+                        float *c, const lgint ldc);
+
+// the epilogue alone on C(m, n), for a product computed elsewhere (sparse X)
+void cml_gemm_epilogue(const struct cml_gemm_epilogue *ep, const lgint m, const lgint n, fdouble *c, const lgint ldc);
+
+void cml_gemm_epilogue_f32(const struct cml_gemm_epilogue *ep, const lgint m, const lgint n, float *c, const lgint ldc);
+
+#endif
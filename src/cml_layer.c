@@ -1,7 +1,8 @@
 #include "cml_layer.h"
+#include "cml_gemm.h"
+#include "cml_matrix_impl.h"
 
-#include <float.h>
-#include <math.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -16,10 +17,17 @@ struct layer
 };
 
 static cml_matrix *layer_bias(cml_layer *const layer);
+static void layer_cast(cml_layer *const layer, const cml_dtype dtype);
 static void layer_compile(cml_layer *const layer, const lgint n_inputs, cml_prng *const prng);
 static cml_matrix *layer_eval(cml_layer *const layer, cml_matrix *const x);
+static cml_matrix *layer_eval_into(cml_layer *const layer, cml_matrix *const x, cml_matrix *out);
+static cml_matrix *layer_eval_sparse_into(cml_layer *const layer, cml_sparse *const x, cml_matrix *out);
+static cml_matrix *layer_forward_into(cml_layer *const layer, cml_matrix *const x, cml_matrix *out, cml_matrix *grad);
+static cml_matrix *layer_forward_sparse_into(cml_layer *const layer, cml_sparse *const x, cml_matrix *out, cml_matrix *grad);
 static void layer_free(cml_layer **layer);
 static cml_matrix *layer_gradient(cml_layer *const layer, cml_matrix *const x);
+static cml_matrix *layer_gradient_into(cml_layer *const layer, cml_matrix *const x, cml_matrix *out);
+static cml_matrix *layer_gradient_sparse_into(cml_layer *const layer, cml_sparse *const x, cml_matrix *out);
 static void layer_print(cml_layer *const layer);
 static cml_matrix *layer_weight(cml_layer *const layer);
 
@@ -30,10 +38,17 @@ cml_layer *cml_layer_create(const lgint units, const cml_activation activation)
     *(cml_activation *)(&layer->pub.activation) = activation;
 
     layer->pub.bias = &layer_bias;
+    layer->pub.cast = &layer_cast;
     layer->pub.compile = &layer_compile;
     layer->pub.eval = &layer_eval;
+    layer->pub.eval_into = &layer_eval_into;
+    layer->pub.eval_sparse_into = &layer_eval_sparse_into;
+    layer->pub.forward_into = &layer_forward_into;
+    layer->pub.forward_sparse_into = &layer_forward_sparse_into;
     layer->pub.free = &layer_free;
     layer->pub.gradient = &layer_gradient;
+    layer->pub.gradient_into = &layer_gradient_into;
+    layer->pub.gradient_sparse_into = &layer_gradient_sparse_into;
     layer->pub.print = &layer_print;
     layer->pub.weight = &layer_weight;
 
@@ -51,6 +66,30 @@ cml_matrix *layer_bias(cml_layer *const self)
     return layer->bias;
 }
 
+void layer_cast(cml_layer *const self, const cml_dtype dtype)
+{
+    if (self == NULL)
+        return;
+    struct layer *layer = (struct layer *)self;
+    if (layer->weight == NULL || layer->bias == NULL)
+    {
+        fprintf(stderr, "error (layer_cast): the layer should be compiled first.\n");
+        return;
+    }
+    if (layer->weight->dtype != dtype)
+    {
+        cml_matrix *weight = cml_matrix_cast(layer->weight, dtype);
+        layer->weight->vt->free(&layer->weight);
+        layer->weight = weight;
+    }
+    if (layer->bias->dtype != dtype)
+    {
+        cml_matrix *bias = cml_matrix_cast(layer->bias, dtype);
+        layer->bias->vt->free(&layer->bias);
+        layer->bias = bias;
+    }
+}
+
 void layer_compile(cml_layer *const self, const lgint n_inputs, cml_prng *const prng)
 {
     if (self == NULL)
@@ -69,55 +108,136 @@ void layer_compile(cml_layer *const self, const lgint n_inputs, cml_prng *const
             fdouble value = 0.;
             if (prng != NULL)
                 value = prng->normal(prng, mu, sigma);
-            layer->weight->set(&layer->weight, i, j, value);
+            matrix_store(layer->weight, i, j, value);
         }
         fdouble value = 0.;
         if (prng != NULL)
             value = prng->normal(prng, mu, sigma);
-        layer->bias->set(&layer->bias, j, 0, value);
+        matrix_store(layer->bias, j, 0, value);
     }
 }
 
-static fdouble layer_compute(cml_layer *const layer, const fdouble x)
+// whether X*w can be evaluated into `out` for X (m, n) of type `dtype`, reporting the error on behalf of `caller`
+static bool layer_check(cml_layer *const self, const lgint m, const lgint n, const cml_dtype dtype, cml_matrix *const out, const char *caller)
 {
-    switch (layer->activation)
+    struct layer *layer = (struct layer *)self;
+    if (layer->weight == NULL)
     {
-    case LINEAR:
-        return eval_linear(x);
-    case RELU:
-        return eval_relu(x);
-    case LEAKY_RELU:
-        return eval_leaky_relu(x);
-    case SIGMOID:
-        return eval_sigmoid(x);
-    case TANH:
-        return eval_tanh(x);
-    case SOFTMAX:
-        return exp(x);
-    default:
-        return DBL_MAX;
+        fprintf(stderr, "error (%s): the matrix w is null in X*w.\n", caller);
+        return false;
     }
+    if (n != layer->weight->m)
+    {
+        fprintf(stderr, "error (%s): the matrices (%ld, %ld) and (%ld, %ld) are not product compatible in X*w.\n", caller, m, n, layer->weight->m, layer->weight->n);
+        return false;
+    }
+    if (dtype != layer->weight->dtype)
+    {
+        fprintf(stderr, "error (%s): the matrix X and the layer should be of same dtype.\n", caller);
+        return false;
+    }
+    if (out == NULL || out->m != m || out->n != layer->weight->n || out->dtype != dtype)
+    {
+        fprintf(stderr, "error (%s): the output matrix should be (%ld, %ld) and of the dtype of X.\n", caller, m, layer->weight->n);
+        return false;
+    }
+    return true;
+}
+
+// whether the matrix `written` by the layer, named `name`, lies apart from X (NULL when sparse),
+// the weights and the bias, which are read while it is written
+static bool layer_check_apart(cml_layer *const self, cml_matrix *const written, cml_matrix *const x, const char *name, const char *caller)
+{
+    struct layer *layer = (struct layer *)self;
+    if ((x != NULL && matrix_overlap(written, x)) || matrix_overlap(written, layer->weight) ||
+        (layer->bias != NULL && matrix_overlap(written, layer->bias)))
+    {
+        fprintf(stderr, "error (%s): the %s matrix can not overlap X or the parameters of the layer.\n", caller, name);
+        return false;
+    }
+    return true;
 }
 
-static fdouble layer_compute_grad(cml_layer *const layer, const fdouble x)
+static bool layer_check_dense(cml_layer *const self, cml_matrix *const x, cml_matrix *const out, const char *caller)
 {
-    switch (layer->activation)
+    if (self == NULL)
+        return false;
+    if (x == NULL)
     {
-    case LINEAR:
-        return eval_linear_grad(x);
-    case RELU:
-        return eval_relu_grad(x);
-    case LEAKY_RELU:
-        return eval_leaky_relu_grad(x);
-    case SIGMOID:
-        return eval_sigmoid_grad(x);
-    case TANH:
-        return eval_tanh_grad(x);
-    case SOFTMAX:
-        return exp(x);
-    default:
-        return DBL_MAX;
+        fprintf(stderr, "error (%s): the matrix X is null in X*w.\n", caller);
+        return false;
     }
+    return layer_check(self, x->m, x->n, x->dtype, out, caller) && layer_check_apart(self, out, x, "output", caller);
+}
+
+static bool layer_check_sparse(cml_layer *const self, cml_sparse *const x, cml_matrix *const out, const char *caller)
+{
+    if (self == NULL)
+        return false;
+    if (x == NULL)
+    {
+        fprintf(stderr, "error (%s): the matrix X is null in X*w.\n", caller);
+        return false;
+    }
+    return layer_check(self, x->m, x->n, x->dtype, out, caller) && layer_check_apart(self, out, NULL, "output", caller);
+}
+
+// whether `grad` can receive the derivative next to the output `out` of X (NULL when sparse)
+static bool layer_check_grad(cml_layer *const self, cml_matrix *const x, cml_matrix *const out, cml_matrix *const grad, const char *caller)
+{
+    if (grad == NULL || grad->m != out->m || grad->n != out->n || grad->dtype != out->dtype || matrix_overlap(grad, out))
+    {
+        fprintf(stderr, "error (%s): the derivative matrix should be of the shape and dtype of the output, apart from it.\n", caller);
+        return false;
+    }
+    return layer_check_apart(self, grad, x, "derivative", caller);
+}
+
+// the bias and the activation (or its derivative) of the layer, applied to
+// the rows of z = X*w, with the derivative also stored in `grad` when it is
+// not NULL
+static struct cml_gemm_epilogue layer_epilogue(cml_layer *const self, const bool derivative, cml_matrix *const grad)
+{
+    struct layer *layer = (struct layer *)self;
+    const struct cml_gemm_epilogue ep = {self->activation, derivative, layer->bias->data,
+                                         (grad != NULL) ? grad->data : NULL, (grad != NULL) ? matrix_ld(grad) : 0};
+    return ep;
+}
+
+// activation(X*w + b) or its derivative in `out`, in a single pass: the
+// product applies the bias and the activation to each tile of `out` as it
+// computes it
+static cml_matrix *layer_product(cml_layer *const self, cml_matrix *const x, cml_matrix *out, const bool derivative, cml_matrix *const grad)
+{
+    struct layer *layer = (struct layer *)self;
+    if (matrix_unshare(out, false) == NULL || (grad != NULL && matrix_unshare(grad, false) == NULL))
+        return NULL;
+
+    const struct cml_gemm_epilogue ep = layer_epilogue(self, derivative, grad);
+    if (x->dtype == FLOAT32)
+        cml_gemm_fused_f32(false, false, out->m, out->n, x->n,
+                           1.f, matrix_data_f32(x), matrix_ld(x),
+                           matrix_data_f32(layer->weight), matrix_ld(layer->weight),
+                           &ep, matrix_data_f32(out), matrix_ld(out));
+    else
+        cml_gemm_fused(false, false, out->m, out->n, x->n,
+                       1., matrix_data(x), matrix_ld(x),
+                       matrix_data(layer->weight), matrix_ld(layer->weight),
+                       &ep, matrix_data(out), matrix_ld(out));
+    return out;
+}
+
+// the bias and the activation (or its derivative) applied to z = X*w in `out`
+static cml_matrix *layer_activate(cml_layer *const self, cml_matrix *out, const bool derivative, cml_matrix *const grad)
+{
+    if (out == NULL || (grad != NULL && matrix_unshare(grad, false) == NULL))
+        return NULL;
+    const struct cml_gemm_epilogue ep = layer_epilogue(self, derivative, grad);
+    if (out->dtype == FLOAT32)
+        cml_gemm_epilogue_f32(&ep, out->m, out->n, matrix_data_f32(out), matrix_ld(out));
+    else
+        cml_gemm_epilogue(&ep, out->m, out->n, matrix_data(out), matrix_ld(out));
+    return out;
 }
 
 // compute activation(z) = activation(X*w + b)
@@ -126,60 +246,62 @@ cml_matrix *layer_eval(cml_layer *const self, cml_matrix *const x)
     if (self == NULL || x == NULL)
         return NULL;
     struct layer *layer = (struct layer *)self;
-
-    if (x == NULL)
-    {
-        fprintf(stderr, "error (layer_eval): the matrix X is null in X*w.\n");
-        return NULL;
-    }
     if (layer->weight == NULL)
     {
         fprintf(stderr, "error (layer_eval): the matrix w is null in X*w.\n");
         return NULL;
     }
-    if (x->n != layer->weight->m)
-    {
-        fprintf(stderr, "error (layer_eval): the matrices (%ld, %ld) and (%ld, %ld) are not product compatible in X*w.\n", x->m, x->n, layer->weight->m, layer->weight->n);
-        return NULL;
-    }
 
-    cml_matrix *z = cml_matrix_alloc(x->m, layer->weight->n);
-    for (lgint i = 0; i < z->m; i++)
-    {
-        fdouble sprob = 0;
-        for (lgint j = 0; j < z->n; j++)
-        {
-            fdouble s = 0.;
-            for (lgint k = 0; k < x->n; k++)
-            {
-                s += x->get(x, i, k) * layer->weight->get(layer->weight, k, j);
-            }
-            const fdouble xij = s + layer->bias->get(layer->bias, j, 0);
-            const fdouble value = layer_compute(self, xij);
-            z->set(&z, i, j, value);
-            sprob += value;
-        }
-        if (self->activation == SOFTMAX)
-        {
-            for (lgint j = 0; j < z->n; j++)
-            {
-                const fdouble value = z->get(z, i, j);
-                z->set(&z, i, j, value / sprob);
-            }
-        }
-    }
+    cml_matrix *z = cml_matrix_alloc_dtype(x->m, layer->weight->n, x->dtype);
+    if (layer_eval_into(self, x, z) == NULL && z != NULL)
+        z->vt->free(&z);
     return z;
 }
 
+cml_matrix *layer_eval_into(cml_layer *const self, cml_matrix *const x, cml_matrix *out)
+{
+    if (!layer_check_dense(self, x, out, "layer_eval_into"))
+        return NULL;
+    return layer_product(self, x, out, false, NULL);
+}
+
+// the product only visits the stored elements of X
+cml_matrix *layer_eval_sparse_into(cml_layer *const self, cml_sparse *const x, cml_matrix *out)
+{
+    if (!layer_check_sparse(self, x, out, "layer_eval_sparse_into"))
+        return NULL;
+    struct layer *layer = (struct layer *)self;
+
+    return layer_activate(self, cml_sparse_gemm(false, 1., x, layer->weight, 0., out), false, NULL);
+}
+
+// eval_into keeping activation_prime(X*w + b) in `grad` for the backward
+// pass, from the same product
+cml_matrix *layer_forward_into(cml_layer *const self, cml_matrix *const x, cml_matrix *out, cml_matrix *grad)
+{
+    if (!layer_check_dense(self, x, out, "layer_forward_into") || !layer_check_grad(self, x, out, grad, "layer_forward_into"))
+        return NULL;
+    return layer_product(self, x, out, false, grad);
+}
+
+cml_matrix *layer_forward_sparse_into(cml_layer *const self, cml_sparse *const x, cml_matrix *out, cml_matrix *grad)
+{
+    if (!layer_check_sparse(self, x, out, "layer_forward_sparse_into") || !layer_check_grad(self, NULL, out, grad, "layer_forward_sparse_into"))
+        return NULL;
+    struct layer *layer = (struct layer *)self;
+
+    return layer_activate(self, cml_sparse_gemm(false, 1., x, layer->weight, 0., out), false, grad);
+}
+
 void layer_free(cml_layer **self)
 {
     if (*self == NULL)
         return;
     struct layer *layer = (struct layer *)(*self);
     if (layer->weight != NULL)
-        layer->weight->free(&layer->weight);
+        layer->weight->vt->free(&layer->weight);
     if (layer->bias != NULL)
-        layer->bias->free(&layer->bias);
+        layer->bias->vt->free(&layer->bias);
     free(layer);
     *self = NULL;
 }
@@ -190,39 +312,34 @@ cml_matrix *layer_gradient(cml_layer *const self, cml_matrix *const x)
     if (self == NULL || x == NULL)
         return NULL;
     struct layer *layer = (struct layer *)self;
-
-    if (x == NULL)
-    {
-        fprintf(stderr, "error (layer_gradient): the matrix X is null in X*w.\n");
-        return NULL;
-    }
     if (layer->weight == NULL)
     {
         fprintf(stderr, "error (layer_gradient): the matrix w is null in X*w.\n");
         return NULL;
     }
-    if (x->n != layer->weight->m)
-    {
-        fprintf(stderr, "error (layer_gradient): the matrices (%ld, %ld) and (%ld, %ld) are not product compatible in X*w.\n", x->m, x->n, layer->weight->m, layer->weight->n);
-        return NULL;
-    }
-    cml_matrix *z = cml_matrix_alloc(x->m, layer->weight->n);
-    for (lgint i = 0; i < z->m; i++)
-    {
-        for (lgint j = 0; j < z->n; j++)
-        {
-            fdouble s = 0.;
-            for (lgint k = 0; k < x->n; k++)
-            {
-                s += x->get(x, i, k) * layer->weight->get(layer->weight, k, j);
-            }
-            const fdouble x = s + layer->bias->get(layer->bias, j, 0);
-            z->set(&z, i, j, layer_compute_grad(self, x));
-        }
-    }
+
+    cml_matrix *z = cml_matrix_alloc_dtype(x->m, layer->weight->n, x->dtype);
+    if (layer_gradient_into(self, x, z) == NULL && z != NULL)
+        z->vt->free(&z);
     return z;
 }
 
+cml_matrix *layer_gradient_into(cml_layer *const self, cml_matrix *const x, cml_matrix *out)
+{
+    if (!layer_check_dense(self, x, out, "layer_gradient_into"))
+        return NULL;
+    return layer_product(self, x, out, true, NULL);
+}
+
+cml_matrix *layer_gradient_sparse_into(cml_layer *const self, cml_sparse *const x, cml_matrix *out)
+{
+    if (!layer_check_sparse(self, x, out, "layer_gradient_sparse_into"))
+        return NULL;
+    struct layer *layer = (struct layer *)self;
+
+    return layer_activate(self, cml_sparse_gemm(false, 1., x, layer->weight, 0., out), true, NULL);
+}
+
 void layer_print(cml_layer *const self)
 {
     if (self == NULL)
@@ -232,11 +349,11 @@ void layer_print(cml_layer *const self)
     printf("activation: %s\n", cml_activation_name(&self->activation));
     struct layer *layer = (struct layer *)self;
     if (layer->weight != NULL)
-        layer->weight->print(layer->weight);
+        layer->weight->vt->print(layer->weight);
     else
         printf("weight=null\n");
     if (layer->bias != NULL)
-        layer->bias->print(layer->bias);
+        layer->bias->vt->print(layer->bias);
     else
         printf("bias=null\n");
 }
@@ -0,0 +1,299 @@
+#include "cml_lu.h"
+#include "cml_gemm.h"
+#include "cml_matrix_impl.h"
+#include "cml_trsm.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// pivot magnitude below which the matrix is taken as singular
+#define CML_LU_TOLERANCE 1E-09
+
+// number of columns factored per panel before the trailing update
+#define CML_LU_BLOCK 64
+
+struct lu
+{
+    /* Public interface */
+    cml_lu pub;
+
+    /* Packed factors in double precision, row i was swapped with row pivots[i] */
+    cml_matrix *a;
+    lgint *pivots;
+    lgint swaps;
+
+    /* Type of the factored matrix */
+    cml_dtype dtype;
+};
+
+static fdouble lu_det(cml_lu *const lu);
+static void lu_free(cml_lu **lu);
+static cml_matrix *lu_inv(cml_lu *const lu);
+static cml_matrix *lu_solve(cml_lu *const lu, cml_matrix *const b);
+static void lu_unpack(cml_lu *const lu, cml_matrix **p, cml_matrix **l, cml_matrix **u);
+
+static void lu_swap_rows(fdouble *a, const lgint lda, const lgint i, const lgint j, const lgint n)
+{
+    fdouble *ri = a + i * lda, *rj = a + j * lda;
+    for (lgint c = 0; c < n; c++)
+    {
+        const fdouble tmp = ri[c];
+        ri[c] = rj[c];
+        rj[c] = tmp;
+    }
+}
+
+// P*A = L*U in place, false when a pivot vanishes
+static bool lu_factor(fdouble *a, const lgint lda, const lgint n, lgint *pivots)
+{
+    for (lgint k = 0; k < n; k += CML_LU_BLOCK)
+    {
+        const lgint kb = (n - k < CML_LU_BLOCK) ? n - k : CML_LU_BLOCK;
+
+        // panel A[k:n, k:k+kb] column by column, the pivot rows are swapped over the whole width
+        for (lgint j = k; j < k + kb; j++)
+        {
+            lgint pivot = j;
+            fdouble max = fabs(a[j * lda + j]);
+            for (lgint i = j + 1; i < n; i++)
+            {
+                if (max < fabs(a[i * lda + j]))
+                {
+                    max = fabs(a[i * lda + j]);
+                    pivot = i;
+                }
+            }
+            pivots[j] = pivot;
+            if (max < CML_LU_TOLERANCE)
+                return false;
+            if (pivot != j)
+                lu_swap_rows(a, lda, j, pivot, n);
+
+            const fdouble *rj = a + j * lda;
+            const fdouble inv = 1. / rj[j];
+            for (lgint i = j + 1; i < n; i++)
+            {
+                fdouble *ri = a + i * lda;
+                ri[j] *= inv;
+                const fdouble l = ri[j];
+                for (lgint c = j + 1; c < k + kb; c++)
+                {
+                    ri[c] -= l * rj[c];
+                }
+            }
+        }
+
+        const lgint rest = n - k - kb;
+        if (rest == 0)
+            break;
+
+        // A12 <= L11^-1*A12
+        fdouble *a12 = a + k * lda + k + kb;
+        cml_trsm(false, false, true, kb, rest, a + k * lda + k, lda, a12, lda);
+
+        // A22 <= A22 - A21*A12
+        cml_gemm(false, false, rest, rest, kb,
+                 -1., a + (k + kb) * lda + k, lda,
+                 a12, lda,
+                 1., a + (k + kb) * lda + k + kb, lda);
+    }
+    return true;
+}
+
+cml_lu *cml_lu_create(cml_matrix *const a)
+{
+    if (a == NULL)
+    {
+        fprintf(stderr, "error (cml_lu_create): the matrix is null.\n");
+        return NULL;
+    }
+    if (a->m != a->n)
+    {
+        fprintf(stderr, "error (cml_lu_create): the matrix should be square.\n");
+        return NULL;
+    }
+
+    struct lu *lu = (struct lu *)malloc(sizeof(*lu));
+    if (lu == NULL)
+    {
+        fprintf(stderr, "error (cml_lu_create): the allocation memory has failed.\n");
+        return NULL;
+    }
+    *(lgint *)(&lu->pub.n) = a->m;
+
+    lu->pub.det = &lu_det;
+    lu->pub.free = &lu_free;
+    lu->pub.inv = &lu_inv;
+    lu->pub.solve = &lu_solve;
+    lu->pub.unpack = &lu_unpack;
+
+    lu->a = matrix_copy_f64(a);
+    lu->pivots = (lgint *)malloc((a->m + 1) * sizeof(*lu->pivots));
+    lu->swaps = 0;
+    lu->dtype = a->dtype;
+    if (lu->a == NULL || lu->pivots == NULL)
+    {
+        fprintf(stderr, "error (cml_lu_create): the allocation memory has failed.\n");
+        cml_lu *self = &lu->pub;
+        lu_free(&self);
+        return NULL;
+    }
+
+    if (!lu_factor(matrix_data(lu->a), matrix_ld(lu->a), a->m, lu->pivots))
+    {
+        fprintf(stderr, "error (cml_lu_create): the matrix is singular.\n");
+        cml_lu *self = &lu->pub;
+        lu_free(&self);
+        return NULL;
+    }
+    for (lgint i = 0; i < a->m; i++)
+    {
+        if (lu->pivots[i] != i)
+            lu->swaps++;
+    }
+
+    return &lu->pub;
+}
+
+fdouble lu_det(cml_lu *const self)
+{
+    if (self == NULL)
+        return 0.;
+    struct lu *lu = (struct lu *)self;
+    fdouble det = (lu->swaps % 2 == 0) ? 1. : -1.;
+    for (lgint i = 0; i < self->n; i++)
+    {
+        det *= matrix_load(lu->a, i, i);
+    }
+    return det;
+}
+
+void lu_free(cml_lu **self)
+{
+    if (*self == NULL)
+        return;
+    struct lu *lu = (struct lu *)(*self);
+    if (lu->a != NULL)
+        lu->a->vt->free(&lu->a);
+    free(lu->pivots);
+    free(lu);
+    *self = NULL;
+}
+
+// X <= A^-1*X in place, X is a double-precision matrix of n rows
+static void lu_substitute(struct lu *lu, cml_matrix *x)
+{
+    const lgint n = lu->pub.n, k = x->n;
+    const fdouble *a = matrix_data(lu->a);
+    const lgint lda = matrix_ld(lu->a);
+    fdouble *b = matrix_data(x);
+    const lgint ldb = matrix_ld(x);
+
+    for (lgint i = 0; i < n; i++)
+    {
+        if (lu->pivots[i] != i)
+            lu_swap_rows(b, ldb, i, lu->pivots[i], k);
+    }
+
+    // L*Y = P*B with the unit lower triangle, then U*X = Y
+    cml_trsm(false, false, true, n, k, a, lda, b, ldb);
+    cml_trsm(true, false, false, n, k, a, lda, b, ldb);
+}
+
+cml_matrix *lu_inv(cml_lu *const self)
+{
+    if (self == NULL)
+        return NULL;
+    struct lu *lu = (struct lu *)self;
+    cml_matrix *x = cml_matrix_alloc_ld(self->n, self->n, 0, FLOAT64);
+    if (x == NULL)
+    {
+        fprintf(stderr, "error (lu_inv): the allocation memory has failed.\n");
+        return NULL;
+    }
+    for (lgint i = 0; i < self->n; i++)
+    {
+        for (lgint j = 0; j < self->n; j++)
+        {
+            matrix_store(x, i, j, (i == j) ? 1. : 0.);
+        }
+    }
+    lu_substitute(lu, x);
+    return matrix_cast_free(x, lu->dtype);
+}
+
+cml_matrix *lu_solve(cml_lu *const self, cml_matrix *const b)
+{
+    if (self == NULL)
+        return NULL;
+    if (b == NULL)
+    {
+        fprintf(stderr, "error (lu_solve): the matrix B is null in resolution of AX=B.\n");
+        return NULL;
+    }
+    if (b->m != self->n)
+    {
+        fprintf(stderr, "error (lu_solve): the matrix B (%ld, %ld) should have %ld rows in resolution of AX=B.\n", b->m, b->n, self->n);
+        return NULL;
+    }
+    cml_matrix *x = matrix_copy_f64(b);
+    if (x == NULL)
+    {
+        fprintf(stderr, "error (lu_solve): the allocation memory has failed.\n");
+        return NULL;
+    }
+    lu_substitute((struct lu *)self, x);
+    return matrix_cast_free(x, b->dtype);
+}
+
+void lu_unpack(cml_lu *const self, cml_matrix **p, cml_matrix **l, cml_matrix **u)
+{
+    *p = *l = *u = NULL;
+    if (self == NULL)
+        return;
+    struct lu *lu = (struct lu *)self;
+    const lgint n = self->n;
+    *p = cml_matrix_zeros_dtype(n, n, lu->dtype);
+    *l = cml_matrix_zeros_dtype(n, n, lu->dtype);
+    *u = cml_matrix_zeros_dtype(n, n, lu->dtype);
+    lgint *rows = (lgint *)malloc((n + 1) * sizeof(*rows));
+    if (*p == NULL || *l == NULL || *u == NULL || rows == NULL)
+    {
+        fprintf(stderr, "error (lu_unpack): the allocation memory has failed.\n");
+        if (*p != NULL)
+            (*p)->vt->free(p);
+        if (*l != NULL)
+            (*l)->vt->free(l);
+        if (*u != NULL)
+            (*u)->vt->free(u);
+        free(rows);
+        return;
+    }
+
+    // row i of P*A is the row rows[i] of A
+    for (lgint i = 0; i < n; i++)
+    {
+        rows[i] = i;
+    }
+    for (lgint i = 0; i < n; i++)
+    {
+        const lgint tmp = rows[i];
+        rows[i] = rows[lu->pivots[i]];
+        rows[lu->pivots[i]] = tmp;
+    }
+    for (lgint i = 0; i < n; i++)
+    {
+        matrix_store(*p, i, rows[i], 1.);
+        matrix_store(*l, i, i, 1.);
+        for (lgint j = 0; j < n; j++)
+        {
+            if (j < i)
+                matrix_store(*l, i, j, matrix_load(lu->a, i, j));
+            else
+                matrix_store(*u, i, j, matrix_load(lu->a, i, j));
+        }
+    }
+    free(rows);
+}
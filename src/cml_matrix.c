@@ -1,21 +1,25 @@
 #include "cml_matrix.h"
+#include "cml_cholesky.h"
+#include "cml_eigen.h"
+#include "cml_gemm.h"
+#include "cml_lu.h"
+#include "cml_matrix_impl.h"
+#include "cml_qr.h"
+#include "cml_simd.h"
+#include "cml_transpose.h"
+#include "cml_trsm.h"
 
 #include <float.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
 
-#define CML_MATRIX_TOLERANCE 1E-09
-
-struct matrix
-{
-    /* Public interface */
-    cml_matrix pub;
-
-    /* Placeholder for data */
-    fdouble data[];
-};
+// diagonal of R relative to its largest element below which a least-squares problem is rank deficient
+#define CML_MATRIX_RANK_TOLERANCE 1E-12
 
 static cml_matrix *matrix_copy(cml_matrix *const a);
 static fdouble matrix_det(cml_matrix *const a);
@@ -31,34 +35,330 @@ static void matrix_softmax(cml_matrix **a);
 static fdouble matrix_trace(cml_matrix *const a);
 static void matrix_transpose(cml_matrix *const a, cml_matrix **at);
 
-cml_matrix *matrix_create(const lgint m, const lgint n, void *(*alloc)(size_t))
+static const cml_matrix_vtable matrix_vtable = {
+    .copy = &matrix_copy,
+    .det = &matrix_det,
+    .free = &matrix_free,
+    .get = &matrix_get,
+    .hadamard = &matrix_hadamard,
+    .inv = &matrix_inv,
+    .lu = &matrix_lu,
+    .normalize = &matrix_normalize,
+    .print = &matrix_print,
+    .set = &matrix_set,
+    .softmax = &matrix_softmax,
+    .trace = &matrix_trace,
+    .transpose = &matrix_transpose,
+};
+
+// header of a matrix (m, n) whose elements start at `base` with rows `ld` apart
+static cml_matrix *matrix_init(struct matrix *mat, const lgint m, const lgint n, const cml_dtype dtype, void *base, const lgint ld)
 {
-    struct matrix *mat = NULL;
-    const size_t size = sizeof(*mat) + m * n * sizeof(*mat->data);
-    mat = (struct matrix *)alloc(size);
     *(lgint *)(&mat->pub.m) = m;
     *(lgint *)(&mat->pub.n) = n;
+    *(cml_dtype *)(&mat->pub.dtype) = dtype;
+
+    *(const cml_matrix_vtable **)(&mat->pub.vt) = &matrix_vtable;
+
+    *(lgint *)(&mat->pub.ld) = ld;
+    *(void **)(&mat->pub.data) = base;
+    mat->buffer = NULL;
+    mat->shared = NULL;
+    mat->home = NULL;
+    mat->parent = NULL;
+    mat->viewed = false;
+    mat->wrapped = false;
+    mat->deleter = NULL;
+    mat->deleter_ctx = NULL;
+    mat->allocator = NULL;
+    mat->size = 0;
+
+    return &mat->pub;
+}
+
+static void *matrix_aligned_alloc(const size_t alignment, const size_t size)
+{
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, alignment, size) != 0)
+        return NULL;
+    return ptr;
+}
 
-    mat->pub.copy = &matrix_copy;
-    mat->pub.det = &matrix_det;
-    mat->pub.free = &matrix_free;
-    mat->pub.get = &matrix_get;
-    mat->pub.hadamard = &matrix_hadamard;
-    mat->pub.inv = &matrix_inv;
-    mat->pub.lu = &matrix_lu;
-    mat->pub.normalize = &matrix_normalize;
-    mat->pub.print = &matrix_print;
-    mat->pub.set = &matrix_set;
-    mat->pub.softmax = &matrix_softmax;
-    mat->pub.trace = &matrix_trace;
-    mat->pub.transpose = &matrix_transpose;
+// elements on their own block: on a cache line, or 2 MiB aligned and backed
+// by huge pages when the kernel allows it for `size` >= CML_MATRIX_HUGEPAGE_SIZE
+static void *matrix_buffer_alloc(const size_t size)
+{
+    if (size < CML_MATRIX_HUGEPAGE_SIZE)
+        return matrix_aligned_alloc(CML_MATRIX_ALIGN, size);
+    const size_t huge = 2 << 20;
+    const size_t rounded = (size + huge - 1) / huge * huge;
+    void *buffer = matrix_aligned_alloc(huge, rounded);
+#ifdef MADV_HUGEPAGE
+    if (buffer != NULL)
+        madvise(buffer, rounded, MADV_HUGEPAGE);
+#endif
+    return buffer;
+}
+
+cml_matrix *matrix_create(cml_allocator *const allocator, const lgint m, const lgint n, const lgint ld, const cml_dtype dtype, const bool zero)
+{
+    struct matrix *mat = NULL;
+    const size_t elsize = (dtype == FLOAT32) ? sizeof(float) : sizeof(fdouble);
+    const size_t payload = m * ld * elsize;
+    void *buffer = NULL;
+    if (allocator != NULL)
+    {
+        // one block from the allocator, which takes care of its alignment and pages
+        mat = (struct matrix *)allocator->alloc(allocator, sizeof(*mat) + payload);
+    }
+    else if (payload < CML_MATRIX_HUGEPAGE_SIZE)
+    {
+        // header and elements in one block, the elements start on a cache line
+        mat = (struct matrix *)matrix_aligned_alloc(CML_MATRIX_ALIGN, sizeof(*mat) + payload);
+    }
+    else
+    {
+        buffer = matrix_buffer_alloc(payload);
+        mat = (buffer != NULL) ? (struct matrix *)matrix_aligned_alloc(CML_MATRIX_ALIGN, sizeof(*mat)) : NULL;
+    }
+    if (mat == NULL)
+    {
+        fprintf(stderr, "error (matrix_create): the allocation memory of a (%ld, %ld) matrix has failed.\n", m, n);
+        free(buffer);
+        return NULL;
+    }
 
+    matrix_init(mat, m, n, dtype, (buffer != NULL) ? buffer : (void *)mat->data, ld);
+    mat->buffer = buffer;
+    mat->allocator = allocator;
+    mat->size = sizeof(*mat) + payload;
+    if (zero)
+        memset(mat->pub.data, 0, payload);
     return &mat->pub;
 }
 
+// leading dimension of n elements of `elsize` bytes: whole cache lines, in odd
+// number so that consecutive rows do not map to the same cache sets
+static lgint matrix_padded_ld(const lgint n, const size_t elsize)
+{
+    const lgint per_line = CML_MATRIX_ALIGN / elsize;
+    lgint lines = (n + per_line - 1) / per_line;
+    if (lines % 2 == 0)
+        lines++;
+    return lines * per_line;
+}
+
+// out <= op(a, b) row by row, in a single call when no operand is a view,
+// with the kernel `op` or `op_f32` matching the type of the operands, returns out
+static cml_matrix *matrix_map(void (*op)(const lgint, const fdouble *, const fdouble *, fdouble *),
+                              void (*op_f32)(const lgint, const float *, const float *, float *),
+                              cml_matrix *const a, cml_matrix *const b, cml_matrix *out)
+{
+    if (matrix_unshare(out, out == a || out == b) == NULL)
+        return NULL;
+    const bool contiguous = matrix_is_contiguous(a) && matrix_is_contiguous(b) && matrix_is_contiguous(out);
+    const lgint rows = contiguous ? 1 : a->m;
+    const lgint n = contiguous ? a->m * a->n : a->n;
+    for (lgint i = 0; i < rows; i++)
+    {
+        if (a->dtype == FLOAT32)
+            op_f32(n, (float *)matrix_ptr(a, i, 0), (float *)matrix_ptr(b, i, 0), (float *)matrix_ptr(out, i, 0));
+        else
+            op(n, (fdouble *)matrix_ptr(a, i, 0), (fdouble *)matrix_ptr(b, i, 0), (fdouble *)matrix_ptr(out, i, 0));
+    }
+    return out;
+}
+
+// C <= alpha*op(A)*op(B) + beta*C for operands already checked, returns C
+static cml_matrix *matrix_gemm(const bool trans_a, const bool trans_b, const fdouble alpha,
+                               cml_matrix *const a, cml_matrix *const b,
+                               const fdouble beta, cml_matrix *c)
+{
+    if (matrix_unshare(c, beta != 0.) == NULL)
+        return NULL;
+    if (a->dtype == FLOAT32)
+        cml_gemm_f32(trans_a, trans_b, c->m, c->n, trans_a ? a->m : a->n,
+                     alpha, matrix_data_f32(a), matrix_ld(a),
+                     matrix_data_f32(b), matrix_ld(b),
+                     beta, matrix_data_f32(c), matrix_ld(c));
+    else
+        cml_gemm(trans_a, trans_b, c->m, c->n, trans_a ? a->m : a->n,
+                 alpha, matrix_data(a), matrix_ld(a),
+                 matrix_data(b), matrix_ld(b),
+                 beta, matrix_data(c), matrix_ld(c));
+    return c;
+}
+
+cml_matrix *matrix_copy_f64(cml_matrix *const a)
+{
+    cml_matrix *out = cml_matrix_alloc_ld(a->m, a->n, 0, FLOAT64);
+    if (out == NULL)
+        return NULL;
+    if (a->dtype == FLOAT64)
+        return cml_matrix_copy_into(a, out);
+    for (lgint i = 0; i < a->m; i++)
+    {
+        for (lgint j = 0; j < a->n; j++)
+        {
+            matrix_store(out, i, j, matrix_load(a, i, j));
+        }
+    }
+    return out;
+}
+
+// `result` of an operation into the fresh matrix `out`, which is freed when the operation has failed
+// (e.g. operands of different types), instead of leaking
+static cml_matrix *matrix_or_free(cml_matrix *const result, cml_matrix *out)
+{
+    if (result == NULL && out != NULL)
+        out->vt->free(&out);
+    return result;
+}
+
+cml_matrix *matrix_cast_free(cml_matrix *a, const cml_dtype dtype)
+{
+    if (a == NULL || a->dtype == dtype)
+        return a;
+    cml_matrix *out = cml_matrix_cast(a, dtype);
+    a->vt->free(&a);
+    return out;
+}
+
+// drop one reference to the storage, the last one frees it
+static void matrix_storage_release(struct matrix_storage *storage)
+{
+    if (__atomic_sub_fetch(&storage->refs, 1, __ATOMIC_ACQ_REL) != 0)
+        return;
+    free(storage->buffer);
+    free(storage->block);
+    free(storage);
+}
+
+cml_matrix *matrix_unshare_slow(cml_matrix *const a, const bool keep)
+{
+    struct matrix *mat = (struct matrix *)a;
+    struct matrix_storage *shared = mat->shared;
+    // references held by A itself: its elements, and its header when they lie in its block
+    const lgint own = (mat->home == shared) ? 2 : 1;
+    if (__atomic_load_n(&shared->refs, __ATOMIC_ACQUIRE) == own)
+    {
+        // the last reader writes in place, and takes the elements back unless they lie in the block of another header
+        if (shared->block == NULL || mat->home == shared)
+        {
+            mat->buffer = shared->buffer;
+            shared->buffer = NULL;
+            mat->shared = NULL;
+            matrix_storage_release(shared);
+        }
+        return a;
+    }
+
+    const size_t size = a->m * matrix_ld(a) * matrix_elsize(a);
+    void *buffer = matrix_buffer_alloc(size);
+    if (buffer == NULL)
+    {
+        fprintf(stderr, "error (matrix_unshare): the allocation memory of a (%ld, %ld) matrix has failed.\n", a->m, a->n);
+        return NULL;
+    }
+    if (keep)
+        memcpy(buffer, a->data, size);
+    *(void **)(&mat->pub.data) = buffer;
+    mat->buffer = buffer;
+    mat->shared = NULL;
+    matrix_storage_release(shared);
+    return a;
+}
+
 cml_matrix *cml_matrix_alloc(const lgint m, const lgint n)
 {
-    return matrix_create(m, n, &malloc);
+    return matrix_create(NULL, m, n, n, FLOAT64, false);
+}
+
+cml_matrix *cml_matrix_alloc_dtype(const lgint m, const lgint n, const cml_dtype dtype)
+{
+    return matrix_create(NULL, m, n, n, dtype, false);
+}
+
+cml_matrix *cml_matrix_alloc_ld(const lgint m, const lgint n, const lgint ld, const cml_dtype dtype)
+{
+    if (ld == 0)
+        return matrix_create(NULL, m, n, matrix_padded_ld(n, (dtype == FLOAT32) ? sizeof(float) : sizeof(fdouble)), dtype, false);
+    if (ld < n)
+    {
+        fprintf(stderr, "error (cml_matrix_alloc_ld): the leading dimension %ld is smaller than the number of columns %ld.\n", ld, n);
+        return NULL;
+    }
+    return matrix_create(NULL, m, n, ld, dtype, false);
+}
+
+cml_matrix *cml_matrix_alloc_with(cml_allocator *const allocator, const lgint m, const lgint n, const cml_dtype dtype)
+{
+    if (allocator == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_alloc_with): the allocator is null.\n");
+        return NULL;
+    }
+    return matrix_create(allocator, m, n, n, dtype, false);
+}
+
+cml_matrix *cml_matrix_cast(cml_matrix *const a, const cml_dtype dtype)
+{
+    if (a == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_cast): the matrix is null.\n");
+        return NULL;
+    }
+    if (a->dtype == dtype)
+        return a->vt->copy(a);
+    cml_matrix *out = cml_matrix_alloc_dtype(a->m, a->n, dtype);
+    if (out == NULL)
+        return NULL;
+    for (lgint i = 0; i < a->m; i++)
+    {
+        for (lgint j = 0; j < a->n; j++)
+        {
+            matrix_store(out, i, j, matrix_load(a, i, j));
+        }
+    }
+    return out;
+}
+
+cml_matrix *cml_matrix_cholesky(cml_matrix *const a)
+{
+    if (a == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_cholesky): the matrix is null.\n");
+        return NULL;
+    }
+    if (a->m != a->n)
+    {
+        fprintf(stderr, "error (cml_matrix_cholesky): the matrix should be square.\n");
+        return NULL;
+    }
+    cml_matrix *u = matrix_copy_f64(a);
+    if (u == NULL)
+        return NULL;
+    if (!cml_cholesky(a->m, matrix_data(u), matrix_ld(u)))
+    {
+        fprintf(stderr, "error (cml_matrix_cholesky): the matrix is not positive definite.\n");
+        u->vt->free(&u);
+        return NULL;
+    }
+
+    // L = U^T
+    cml_matrix *l = cml_matrix_zeros_dtype(a->m, a->n, a->dtype);
+    if (l != NULL)
+    {
+        for (lgint i = 0; i < a->m; i++)
+        {
+            for (lgint j = 0; j <= i; j++)
+            {
+                matrix_store(l, i, j, matrix_load(u, j, i));
+            }
+        }
+    }
+    u->vt->free(&u);
+    return l;
 }
 
 cml_matrix *cml_matrix_confusion(cml_matrix *const yhat, cml_matrix *const y)
@@ -76,7 +376,7 @@ cml_matrix *cml_matrix_confusion(cml_matrix *const yhat, cml_matrix *const y)
         lgint target_class = 0;
         for (lgint j = 0; j < y->n; j++)
         {
-            if (y->get(y, i, j) == 1)
+            if (matrix_load(y, i, j) == 1)
             {
                 target_class = j;
                 break;
@@ -87,19 +387,59 @@ cml_matrix *cml_matrix_confusion(cml_matrix *const yhat, cml_matrix *const y)
         lgint predicted_class = 0;
         for (lgint j = 0; j < yhat->n; j++)
         {
-            if (yhat->get(yhat, i, j) == 1)
+            if (matrix_load(yhat, i, j) == 1)
             {
                 predicted_class = j;
                 break;
             }
         }
-        const lgint k = (lgint)report->get(report, target_class, predicted_class);
-        report->set(&report, target_class, predicted_class, k + 1);
+        const lgint k = (lgint)matrix_load(report, target_class, predicted_class);
+        matrix_store(report, target_class, predicted_class, k + 1);
     }
 
     return report;
 }
 
+cml_matrix *cml_matrix_copy_into(cml_matrix *const a, cml_matrix *out)
+{
+    if (a == NULL || out == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_copy_into): the matrix A or the output is null.\n");
+        return NULL;
+    }
+    if (a->m != out->m || a->n != out->n || a->dtype != out->dtype)
+    {
+        fprintf(stderr, "error (cml_matrix_copy_into): the output should be of same dimension and dtype as A.\n");
+        return NULL;
+    }
+    // nothing to do for a copy still sharing the elements of A
+    if (out == a || (out->data == a->data && matrix_ld(out) == matrix_ld(a)))
+        return out;
+    if (matrix_unshare(out, false) == NULL)
+        return NULL;
+    // A and OUT may be overlapping views of one matrix
+    if (matrix_is_contiguous(a) && matrix_is_contiguous(out))
+    {
+        memmove(matrix_ptr(out, 0, 0), matrix_ptr(a, 0, 0), a->m * a->n * matrix_elsize(a));
+        return out;
+    }
+    const bool overlap = matrix_overlap(out, a);
+    if (overlap && matrix_ld(out) != matrix_ld(a))
+    {
+        fprintf(stderr, "error (cml_matrix_copy_into): the output can only overlap A with the same row stride.\n");
+        return NULL;
+    }
+    // with the same stride, the rows are copied from the last one when OUT lies after A,
+    // so that each row of A is read before it is overwritten
+    const bool backward = overlap && (uintptr_t)out->data > (uintptr_t)a->data;
+    for (lgint r = 0; r < a->m; r++)
+    {
+        const lgint i = backward ? a->m - 1 - r : r;
+        memmove(matrix_ptr(out, i, 0), matrix_ptr(a, i, 0), a->n * matrix_elsize(a));
+    }
+    return out;
+}
+
 cml_matrix *cml_matrix_dif(cml_matrix *const a, cml_matrix *const b)
 {
     if (a == NULL)
@@ -117,15 +457,75 @@ cml_matrix *cml_matrix_dif(cml_matrix *const a, cml_matrix *const b)
         fprintf(stderr, "error (cml_matrix_dif): the matrices should be of same dimension in A-B.\n");
         return NULL;
     }
-    cml_matrix *d = cml_matrix_alloc(a->m, a->n);
-    for (lgint i = 0; i < d->m; i++)
+    cml_matrix *out = cml_matrix_alloc_dtype(a->m, a->n, a->dtype);
+    return matrix_or_free(cml_matrix_dif_into(a, b, out), out);
+}
+
+cml_matrix *cml_matrix_dif_into(cml_matrix *const a, cml_matrix *const b, cml_matrix *out)
+{
+    if (a == NULL || b == NULL || out == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_dif_into): a matrix is null in OUT=A-B.\n");
+        return NULL;
+    }
+    if (a->m != b->m || a->n != b->n || a->m != out->m || a->n != out->n || a->dtype != b->dtype || a->dtype != out->dtype)
+    {
+        fprintf(stderr, "error (cml_matrix_dif_into): the matrices should be of same dimension and dtype in OUT=A-B.\n");
+        return NULL;
+    }
+    return matrix_map(&cml_vec_sub, &cml_vec_sub_f32, a, b, out);
+}
+
+void cml_matrix_eigh(cml_matrix *const a, cml_matrix **w, cml_matrix **v)
+{
+    *w = *v = NULL;
+    if (a == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_eigh): the matrix is null.\n");
+        return;
+    }
+    if (a->m != a->n)
+    {
+        fprintf(stderr, "error (cml_matrix_eigh): the matrix (%ld, %ld) should be square.\n", a->m, a->n);
+        return;
+    }
+    const lgint n = a->n;
+    cml_matrix *f = matrix_copy_f64(a);
+    cml_matrix *values = cml_matrix_alloc(n, 1);
+    if (f == NULL || values == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_eigh): the allocation memory has failed.\n");
+    }
+    else if (!cml_syev(n, matrix_data(f), matrix_ld(f), matrix_data(values)))
     {
-        for (lgint j = 0; j < d->n; j++)
+        fprintf(stderr, "error (cml_matrix_eigh): the eigenvalues have not converged.\n");
+    }
+    else
+    {
+        // the eigenvectors are in the rows of F
+        *v = cml_matrix_alloc_dtype(n, n, a->dtype);
+        for (lgint i = 0; *v != NULL && i < n; i++)
+        {
+            for (lgint j = 0; j < n; j++)
+            {
+                matrix_store(*v, i, j, matrix_load(f, j, i));
+            }
+        }
+        *w = matrix_cast_free(values, a->dtype);
+        values = NULL;
+        if (*v == NULL || *w == NULL)
         {
-            d->set(&d, i, j, a->get(a, i, j) - b->get(b, i, j));
+            fprintf(stderr, "error (cml_matrix_eigh): the allocation memory has failed.\n");
+            if (*v != NULL)
+                (*v)->vt->free(v);
+            if (*w != NULL)
+                (*w)->vt->free(w);
         }
     }
-    return d;
+    if (f != NULL)
+        f->vt->free(&f);
+    if (values != NULL)
+        values->vt->free(&values);
 }
 
 cml_matrix *cml_matrix_eye(const lgint n)
@@ -133,392 +533,716 @@ cml_matrix *cml_matrix_eye(const lgint n)
     cml_matrix *a = cml_matrix_zeros(n, n);
     for (lgint i = 0; i < a->m; i++)
     {
-        a->set(&a, i, i, 1.);
+        matrix_store(a, i, i, 1.);
     }
     return a;
 }
 
-cml_matrix *cml_matrix_prod(cml_matrix *const a, cml_matrix *const b)
+cml_matrix *cml_matrix_gemm(const bool trans_a, const bool trans_b, const fdouble alpha,
+                            cml_matrix *const a, cml_matrix *const b,
+                            const fdouble beta, cml_matrix *c)
 {
-    if (a == NULL)
+    if (a == NULL || b == NULL || c == NULL)
     {
-        fprintf(stderr, "error (cml_matrix_prod): the matrix A is null in A*B.\n");
+        fprintf(stderr, "error (cml_matrix_gemm): a matrix is null in C=alpha*op(A)*op(B)+beta*C.\n");
         return NULL;
     }
-    if (b == NULL)
+    const lgint m = trans_a ? a->n : a->m;
+    const lgint k = trans_a ? a->m : a->n;
+    const lgint kb = trans_b ? b->n : b->m;
+    const lgint n = trans_b ? b->m : b->n;
+    if (k != kb || c->m != m || c->n != n)
     {
-        fprintf(stderr, "error (cml_matrix_prod): the matrix B is null in A*B.\n");
+        fprintf(stderr, "error (cml_matrix_gemm): the matrices (%ld, %ld) and (%ld, %ld) are not product compatible with C (%ld, %ld).\n", m, k, kb, n, c->m, c->n);
         return NULL;
     }
-    if (a->n != b->m)
+    if (a->dtype != b->dtype || a->dtype != c->dtype)
     {
-        fprintf(stderr, "error (cml_matrix_prod): the matrices should be product compatible in A*B.\n");
+        fprintf(stderr, "error (cml_matrix_gemm): the matrices should be of same dtype.\n");
+        return NULL;
+    }
+    if (matrix_overlap(c, a) || matrix_overlap(c, b))
+    {
+        fprintf(stderr, "error (cml_matrix_gemm): C can not overlap an operand.\n");
         return NULL;
     }
-    cml_matrix *p = cml_matrix_alloc(a->m, b->n);
-    for (lgint i = 0; i < p->m; i++)
+    return matrix_gemm(trans_a, trans_b, alpha, a, b, beta, c);
+}
+
+cml_matrix *cml_matrix_hadamard_into(cml_matrix *const a, cml_matrix *const b, cml_matrix *out)
+{
+    if (a == NULL || b == NULL || out == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_hadamard_into): a matrix is null in OUT=A.B.\n");
+        return NULL;
+    }
+    if (a->m != b->m || a->n != b->n || a->m != out->m || a->n != out->n || a->dtype != b->dtype || a->dtype != out->dtype)
     {
-        for (lgint j = 0; j < p->n; j++)
+        fprintf(stderr, "error (cml_matrix_hadamard_into): the matrices should be of same dimension and dtype in OUT=A.B.\n");
+        return NULL;
+    }
+    return matrix_map(&cml_vec_mul, &cml_vec_mul_f32, a, b, out);
+}
+
+// whether no diagonal element of the triangular factor R(n, n) in the top of `r` vanishes
+static bool matrix_full_rank(cml_matrix *const r)
+{
+    fdouble rmax = 0.;
+    for (lgint i = 0; i < r->n; i++)
+    {
+        rmax = fmax(rmax, fabs(matrix_load(r, i, i)));
+    }
+    for (lgint i = 0; i < r->n; i++)
+    {
+        if (fabs(matrix_load(r, i, i)) <= CML_MATRIX_RANK_TOLERANCE * rmax)
+            return false;
+    }
+    return true;
+}
+
+cml_matrix *cml_matrix_lstsq(cml_matrix *const a, cml_matrix *const b)
+{
+    if (a == NULL || b == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_lstsq): the matrix A or B is null in min ||AX - B||.\n");
+        return NULL;
+    }
+    if (a->m < a->n || b->m != a->m)
+    {
+        fprintf(stderr, "error (cml_matrix_lstsq): the matrix A (%ld, %ld) should have at least as many rows as columns, and as many rows as B (%ld, %ld).\n", a->m, a->n, b->m, b->n);
+        return NULL;
+    }
+    const lgint n = a->n;
+    cml_matrix *f = matrix_copy_f64(a);
+    cml_matrix *x = matrix_copy_f64(b);
+    fdouble *tau = (fdouble *)malloc((n + 1) * sizeof(*tau));
+    cml_matrix *out = NULL;
+    if (f == NULL || x == NULL || tau == NULL ||
+        !cml_qr(a->m, n, matrix_data(f), matrix_ld(f), tau) ||
+        !cml_qr_apply(true, a->m, n, b->n, matrix_data(f), matrix_ld(f), tau, matrix_data(x), matrix_ld(x)))
+    {
+        fprintf(stderr, "error (cml_matrix_lstsq): the allocation memory has failed.\n");
+    }
+    else if (!matrix_full_rank(f))
+    {
+        fprintf(stderr, "error (cml_matrix_lstsq): the matrix A is rank deficient.\n");
+    }
+    else
+    {
+        // Q^T*B is in X, R*X = (Q^T*B)[0:n]
+        cml_trsm(true, false, false, n, b->n, matrix_data(f), matrix_ld(f), matrix_data(x), matrix_ld(x));
+        cml_matrix *top = cml_matrix_view_rows(x, 0, n);
+        out = cml_matrix_cast(top, b->dtype);
+        top->vt->free(&top);
+    }
+
+    if (f != NULL)
+        f->vt->free(&f);
+    if (x != NULL)
+        x->vt->free(&x);
+    free(tau);
+    return out;
+}
+
+cml_matrix *cml_matrix_normalize_into(cml_matrix *const a, cml_matrix *out)
+{
+    if (a == NULL || out == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_normalize_into): the matrix A or the output is null.\n");
+        return NULL;
+    }
+    if (a->m != out->m || a->n != out->n)
+    {
+        fprintf(stderr, "error (cml_matrix_normalize_into): the output should be of same dimension as A.\n");
+        return NULL;
+    }
+    if (a->m == 0 || a->n == 0)
+        return out;
+    if (matrix_unshare(out, out == a) == NULL)
+        return NULL;
+
+    // the largest magnitude of each column, from its max and its min
+    cml_matrix *coef = cml_matrix_alloc_dtype(1, a->n, a->dtype);
+    coef = matrix_or_free(cml_matrix_reduce_columns(REDUCE_MAX, a, coef), coef);
+    cml_matrix *low = cml_matrix_alloc_dtype(1, a->n, a->dtype);
+    low = matrix_or_free(cml_matrix_reduce_columns(REDUCE_MIN, a, low), low);
+    if (coef == NULL || low == NULL)
+    {
+        if (coef != NULL)
+            coef->vt->free(&coef);
+        if (low != NULL)
+            low->vt->free(&low);
+        return NULL;
+    }
+    for (lgint j = 0; j < a->n; j++)
+    {
+        // a null column is left unchanged
+        fdouble c = fmax(fabs(matrix_load(coef, 0, j)), fabs(matrix_load(low, 0, j)));
+        matrix_store(coef, 0, j, (c == 0.) ? 1. : c);
+    }
+    low->vt->free(&low);
+    for (lgint i = 0; i < a->m; i++)
+    {
+        for (lgint j = 0; j < a->n; j++)
         {
-            fdouble s = 0.;
-            for (lgint k = 0; k < a->n; k++)
-            {
-                s += a->get(a, i, k) * b->get(b, k, j);
-            }
-            p->set(&p, i, j, s);
+            matrix_store(out, i, j, matrix_load(a, i, j) / matrix_load(coef, 0, j));
         }
     }
-    return p;
+    coef->vt->free(&coef);
+    return out;
 }
 
-cml_matrix *cml_matrix_solve(cml_matrix *const a, cml_matrix *const b)
+cml_matrix *cml_matrix_prod(cml_matrix *const a, cml_matrix *const b)
 {
     if (a == NULL)
     {
-        fprintf(stderr, "error (cml_matrix_solve): the matrix A is null in resolution of Ax=b.\n");
+        fprintf(stderr, "error (cml_matrix_prod): the matrix A is null in A*B.\n");
         return NULL;
     }
     if (b == NULL)
     {
-        fprintf(stderr, "error (cml_matrix_solve): the matrix b is null in resolution of Ax=b.\n");
+        fprintf(stderr, "error (cml_matrix_prod): the matrix B is null in A*B.\n");
         return NULL;
     }
-    cml_matrix *ainv = a->inv(a);
-    if (ainv == NULL)
+    if (a->n != b->m)
     {
-        fprintf(stderr, "error (cml_matrix_solve): Ax=b has no solution.\n");
+        fprintf(stderr, "error (cml_matrix_prod): the matrices should be product compatible in A*B.\n");
         return NULL;
     }
-    cml_matrix *x = cml_matrix_prod(ainv, b);
-    ainv->free(&ainv);
-    return x;
+    cml_matrix *out = cml_matrix_alloc_dtype(a->m, b->n, a->dtype);
+    return matrix_or_free(cml_matrix_prod_into(a, b, out), out);
 }
 
-cml_matrix *cml_matrix_sum(cml_matrix *const a, cml_matrix *const b)
+cml_matrix *cml_matrix_prod_into(cml_matrix *const a, cml_matrix *const b, cml_matrix *out)
 {
-    if (a == NULL)
+    if (a == NULL || b == NULL || out == NULL)
     {
-        fprintf(stderr, "error (cml_matrix_sum): the matrix A is null in A+B.\n");
+        fprintf(stderr, "error (cml_matrix_prod_into): a matrix is null in OUT=A*B.\n");
         return NULL;
     }
-    if (b == NULL)
+    if (a->n != b->m || out->m != a->m || out->n != b->n)
     {
-        fprintf(stderr, "error (cml_matrix_sum): the matrix B is null in A+B.\n");
+        fprintf(stderr, "error (cml_matrix_prod_into): the matrices should be product compatible in OUT=A*B.\n");
         return NULL;
     }
-    if (a->m != b->m || a->n != b->n)
+    if (a->dtype != b->dtype || a->dtype != out->dtype)
     {
-        fprintf(stderr, "error (cml_matrix_sum): the matrices should be of same dimension in A+B.\n");
+        fprintf(stderr, "error (cml_matrix_prod_into): the matrices should be of same dtype in OUT=A*B.\n");
         return NULL;
     }
-    cml_matrix *s = cml_matrix_alloc(a->m, a->n);
-    for (lgint i = 0; i < s->m; i++)
+    if (matrix_overlap(out, a) || matrix_overlap(out, b))
     {
-        for (lgint j = 0; j < s->n; j++)
-        {
-            s->set(&s, i, j, a->get(a, i, j) + b->get(b, i, j));
-        }
+        fprintf(stderr, "error (cml_matrix_prod_into): the output can not overlap an operand in OUT=A*B.\n");
+        return NULL;
     }
-    return s;
+    return matrix_gemm(false, false, 1., a, b, 0., out);
 }
 
-static void *matrix_alloc(size_t size)
+cml_matrix *cml_matrix_prod_nt(cml_matrix *const a, cml_matrix *const b)
 {
-    return calloc(size, 1);
+    if (a == NULL || b == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_prod_nt): a matrix is null in A*B^T.\n");
+        return NULL;
+    }
+    if (a->n != b->n)
+    {
+        fprintf(stderr, "error (cml_matrix_prod_nt): the matrices should be product compatible in A*B^T.\n");
+        return NULL;
+    }
+    cml_matrix *out = cml_matrix_alloc_dtype(a->m, b->m, a->dtype);
+    return matrix_or_free(cml_matrix_gemm(false, true, 1., a, b, 0., out), out);
 }
 
-cml_matrix *cml_matrix_zeros(const lgint m, const lgint n)
+cml_matrix *cml_matrix_prod_tn(cml_matrix *const a, cml_matrix *const b)
 {
-    return matrix_create(m, n, &matrix_alloc);
+    if (a == NULL || b == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_prod_tn): a matrix is null in A^T*B.\n");
+        return NULL;
+    }
+    if (a->m != b->m)
+    {
+        fprintf(stderr, "error (cml_matrix_prod_tn): the matrices should be product compatible in A^T*B.\n");
+        return NULL;
+    }
+    cml_matrix *out = cml_matrix_alloc_dtype(a->n, b->n, a->dtype);
+    return matrix_or_free(cml_matrix_gemm(true, false, 1., a, b, 0., out), out);
 }
 
-cml_matrix *matrix_copy(cml_matrix *const a)
+void cml_matrix_qr(cml_matrix *const a, cml_matrix **q, cml_matrix **r)
 {
+    *q = *r = NULL;
     if (a == NULL)
-        return NULL;
-    cml_matrix *b = cml_matrix_alloc(a->m, a->n);
-    for (lgint i = 0; i < b->m; i++)
     {
-        for (lgint j = 0; j < b->n; j++)
+        fprintf(stderr, "error (cml_matrix_qr): the matrix is null.\n");
+        return;
+    }
+    if (a->m < a->n)
+    {
+        fprintf(stderr, "error (cml_matrix_qr): the matrix (%ld, %ld) should have at least as many rows as columns.\n", a->m, a->n);
+        return;
+    }
+    const lgint m = a->m, n = a->n;
+    cml_matrix *f = matrix_copy_f64(a);
+    cml_matrix *e = cml_matrix_zeros(m, n);
+    fdouble *tau = (fdouble *)malloc((n + 1) * sizeof(*tau));
+    if (f != NULL && e != NULL && tau != NULL && cml_qr(m, n, matrix_data(f), matrix_ld(f), tau))
+    {
+        // Q = Q*I(m, n)
+        for (lgint i = 0; i < n; i++)
+        {
+            matrix_store(e, i, i, 1.);
+        }
+        if (cml_qr_apply(false, m, n, n, matrix_data(f), matrix_ld(f), tau, matrix_data(e), matrix_ld(e)))
         {
-            b->set(&b, i, j, a->get(a, i, j));
+            *r = cml_matrix_zeros_dtype(n, n, a->dtype);
+            for (lgint i = 0; *r != NULL && i < n; i++)
+            {
+                for (lgint j = i; j < n; j++)
+                {
+                    matrix_store(*r, i, j, matrix_load(f, i, j));
+                }
+            }
+            *q = matrix_cast_free(e, a->dtype);
+            e = NULL;
         }
     }
-    return b;
+    if (*q == NULL || *r == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_qr): the allocation memory has failed.\n");
+        if (*q != NULL)
+            (*q)->vt->free(q);
+        if (*r != NULL)
+            (*r)->vt->free(r);
+    }
+    if (f != NULL)
+        f->vt->free(&f);
+    if (e != NULL)
+        e->vt->free(&e);
+    free(tau);
 }
 
-static lgint cml_lu(cml_matrix *const a, cml_matrix **p, cml_matrix **l, cml_matrix **u);
-
-fdouble matrix_det(cml_matrix *const a)
+cml_matrix *cml_matrix_solve(cml_matrix *const a, cml_matrix *const b)
 {
     if (a == NULL)
     {
-        fprintf(stderr, "error (matrix_det): the matrix is null.\n");
-        return DBL_MAX;
+        fprintf(stderr, "error (cml_matrix_solve): the matrix A is null in resolution of Ax=b.\n");
+        return NULL;
     }
-    if (a->m == a->n && a->m == 1)
-        return a->get(a, 0, 0);
-
-    cml_matrix *p = NULL, *l = NULL, *u = NULL;
-    lgint n = cml_lu(a, &p, &l, &u);
-    if (p == NULL || l == NULL || u == NULL)
+    if (b == NULL)
     {
-        return 0.;
+        fprintf(stderr, "error (cml_matrix_solve): the matrix b is null in resolution of Ax=b.\n");
+        return NULL;
     }
-
-    fdouble det = 1.;
-    for (lgint i = 0; i < a->m; i++)
+    cml_lu *lu = cml_lu_create(a);
+    if (lu == NULL)
     {
-        det *= u->get(u, i, i);
+        fprintf(stderr, "error (cml_matrix_solve): Ax=b has no solution.\n");
+        return NULL;
     }
-    p->free(&p);
-    l->free(&l);
-    u->free(&u);
-
-    return pow(-1., n) * det;
+    cml_matrix *x = lu->solve(lu, b);
+    lu->free(&lu);
+    return x;
 }
 
-void matrix_free(cml_matrix **a)
+cml_matrix *cml_matrix_solve_spd(cml_matrix *const a, cml_matrix *const b)
 {
-    if (*a == NULL)
-        return;
-    free(*a);
-    *a = NULL;
+    if (a == NULL || b == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_solve_spd): the matrix A or b is null in resolution of Ax=b.\n");
+        return NULL;
+    }
+    if (a->m != a->n || b->m != a->m)
+    {
+        fprintf(stderr, "error (cml_matrix_solve_spd): the matrix A (%ld, %ld) should be square with as many rows as b (%ld, %ld).\n", a->m, a->n, b->m, b->n);
+        return NULL;
+    }
+    cml_matrix *u = matrix_copy_f64(a);
+    if (u == NULL)
+        return NULL;
+    if (!cml_cholesky(a->m, matrix_data(u), matrix_ld(u)))
+    {
+        fprintf(stderr, "error (cml_matrix_solve_spd): the matrix A is not positive definite.\n");
+        u->vt->free(&u);
+        return NULL;
+    }
+    cml_matrix *x = matrix_copy_f64(b);
+    if (x != NULL)
+    {
+        // U^T*Y = B, then U*X = Y
+        cml_trsm(true, true, false, a->m, b->n, matrix_data(u), matrix_ld(u), matrix_data(x), matrix_ld(x));
+        cml_trsm(true, false, false, a->m, b->n, matrix_data(u), matrix_ld(u), matrix_data(x), matrix_ld(x));
+    }
+    u->vt->free(&u);
+    return matrix_cast_free(x, b->dtype);
 }
 
-fdouble matrix_get(cml_matrix *const a, const lgint i, const lgint j)
+cml_matrix *cml_matrix_sum(cml_matrix *const a, cml_matrix *const b)
 {
     if (a == NULL)
-        return DBL_MAX;
-    if (a->m <= i || a->n <= j)
     {
-        fprintf(stderr, "Error (matrix_get): the index (%ld, %ld) is outside of the matrix dimension (%ld, %ld)\n", i, j, a->m, a->n);
-        return DBL_MAX;
+        fprintf(stderr, "error (cml_matrix_sum): the matrix A is null in A+B.\n");
+        return NULL;
     }
-    struct matrix *mat = (struct matrix *)a;
-    return mat->data[i * a->n + j];
+    if (b == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_sum): the matrix B is null in A+B.\n");
+        return NULL;
+    }
+    if (a->m != b->m || a->n != b->n)
+    {
+        fprintf(stderr, "error (cml_matrix_sum): the matrices should be of same dimension in A+B.\n");
+        return NULL;
+    }
+    cml_matrix *out = cml_matrix_alloc_dtype(a->m, a->n, a->dtype);
+    return matrix_or_free(cml_matrix_sum_into(a, b, out), out);
 }
 
-cml_matrix *matrix_hadamard(cml_matrix *const a, cml_matrix *const b)
+cml_matrix *cml_matrix_sum_into(cml_matrix *const a, cml_matrix *const b, cml_matrix *out)
 {
-    if (a->m != b->m || a->n != b->n)
+    if (a == NULL || b == NULL || out == NULL)
     {
-        fprintf(stderr, "Error (matrix_hadamard): the matrices are not element-wise product.\n");
+        fprintf(stderr, "error (cml_matrix_sum_into): a matrix is null in OUT=A+B.\n");
         return NULL;
     }
-    cml_matrix *prod = cml_matrix_alloc(a->m, a->n);
-    for (lgint i = 0; i < a->m; i++)
+    if (a->m != b->m || a->n != b->n || a->m != out->m || a->n != out->n || a->dtype != b->dtype || a->dtype != out->dtype)
     {
-        for (lgint j = 0; j < a->n; j++)
-        {
-            prod->set(
-                &prod,
-                i, j,
-                a->get(a, i, j) * b->get(b, i, j));
-        }
+        fprintf(stderr, "error (cml_matrix_sum_into): the matrices should be of same dimension and dtype in OUT=A+B.\n");
+        return NULL;
     }
-    return prod;
+    return matrix_map(&cml_vec_add, &cml_vec_add_f32, a, b, out);
 }
 
-static lgint matrix_get_pivot(cml_matrix *const a, const lgint i)
+void cml_matrix_svd(cml_matrix *const a, const lgint k, cml_matrix **u, cml_matrix **s, cml_matrix **v)
 {
+    *u = *s = *v = NULL;
     if (a == NULL)
     {
-        return -1;
+        fprintf(stderr, "error (cml_matrix_svd): the matrix is null.\n");
+        return;
+    }
+    if (k == 0 || k > a->m || k > a->n)
+    {
+        fprintf(stderr, "error (cml_matrix_svd): the rank %ld should be between 1 and the dimensions of the matrix (%ld, %ld).\n", k, a->m, a->n);
+        return;
     }
-    lgint pivot = i;
-    fdouble max = fabs(a->get(a, i, i));
-    for (lgint j = i + 1; j < a->n; j++)
+    cml_matrix *f = matrix_copy_f64(a);
+    cml_matrix *uf = cml_matrix_alloc(a->m, k);
+    cml_matrix *sf = cml_matrix_alloc(k, 1);
+    cml_matrix *vtf = cml_matrix_alloc(k, a->n);
+    if (f != NULL && uf != NULL && sf != NULL && vtf != NULL &&
+        cml_rsvd(a->m, a->n, k, matrix_data(f), matrix_ld(f), matrix_data(uf), matrix_data(sf), matrix_data(vtf)))
     {
-        if (max < fabs(a->get(a, j, i)))
+        *u = matrix_cast_free(uf, a->dtype);
+        *s = matrix_cast_free(sf, a->dtype);
+        uf = sf = NULL;
+        *v = cml_matrix_alloc_dtype(a->n, k, a->dtype);
+        for (lgint i = 0; *v != NULL && i < a->n; i++)
         {
-            max = fabs(a->get(a, j, i));
-            pivot = j;
+            for (lgint j = 0; j < k; j++)
+            {
+                matrix_store(*v, i, j, matrix_load(vtf, j, i));
+            }
         }
     }
-    return pivot;
+    if (*u == NULL || *s == NULL || *v == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_svd): the allocation memory has failed.\n");
+        if (*u != NULL)
+            (*u)->vt->free(u);
+        if (*s != NULL)
+            (*s)->vt->free(s);
+        if (*v != NULL)
+            (*v)->vt->free(v);
+    }
+    if (f != NULL)
+        f->vt->free(&f);
+    if (uf != NULL)
+        uf->vt->free(&uf);
+    if (sf != NULL)
+        sf->vt->free(&sf);
+    if (vtf != NULL)
+        vtf->vt->free(&vtf);
 }
 
-static void matrix_pivoting(cml_matrix *a[], const lgint n, const lgint pivot, const lgint i)
+cml_matrix *cml_matrix_syrk(cml_matrix *const x)
 {
-    if (n <= 0 || a == NULL)
-        return;
-    for (lgint j = 0; j < a[0]->n; j++)
+    if (x == NULL)
+    {
+        fprintf(stderr, "error (cml_matrix_syrk): the matrix is null.\n");
+        return NULL;
+    }
+    const lgint n = x->n;
+    cml_matrix *c = cml_matrix_alloc_dtype(n, n, x->dtype);
+    if (c == NULL)
+        return NULL;
+    if (x->dtype == FLOAT32)
+        cml_syrk_f32(n, x->m, 1.f, matrix_data_f32(x), matrix_ld(x), 0.f, matrix_data_f32(c), n);
+    else
+        cml_syrk(n, x->m, 1., matrix_data(x), matrix_ld(x), 0., matrix_data(c), n);
+
+    // mirror the upper triangle
+    for (lgint i = 1; i < n; i++)
     {
-        for (lgint k = 0; k < n; k++)
+        for (lgint j = 0; j < i; j++)
         {
-            const fdouble tmp = a[k]->get(a[k], pivot, j);
-            a[k]->set(&a[k], pivot, j, a[k]->get(a[k], i, j));
-            a[k]->set(&a[k], i, j, tmp);
+            matrix_store(c, i, j, matrix_load(c, j, i));
         }
     }
+    return c;
 }
 
-// row_i <= coef_j*row_j + coef_k*row_k for all the n matrices A
-static void matrix_linear_oper(cml_matrix **a, const int n,
-                               const lgint row_i,
-                               const fdouble coef_j, const lgint row_j,
-                               const fdouble coef_k, const lgint row_k)
+cml_matrix *cml_matrix_unshare(cml_matrix *const a)
 {
-    if (a == NULL || n < 1)
-        return;
-
-    for (lgint j = 0; j < a[0]->n; j++)
+    if (a == NULL)
     {
-        for (int i = 0; i < n; i++)
-        {
-            a[i]->set(
-                &a[i], row_i, j,
-                coef_j * a[i]->get(a[i], row_j, j) + coef_k * a[i]->get(a[i], row_k, j));
-        }
+        fprintf(stderr, "error (cml_matrix_unshare): the matrix is null.\n");
+        return NULL;
     }
+    return matrix_unshare(a, true);
 }
 
-cml_matrix *matrix_inv(cml_matrix *const a)
+cml_matrix *cml_matrix_view(cml_matrix *const a, const lgint i, const lgint j, const lgint m, const lgint n, const lgint step)
 {
     if (a == NULL)
     {
-        fprintf(stderr, "error (matrix_inv): the matrix is null.\n");
+        fprintf(stderr, "error (cml_matrix_view): the matrix is null.\n");
         return NULL;
     }
-    if (a->m != a->n)
+    if (step == 0)
     {
-        fprintf(stderr, "error (matrix_inv): the matrix should be square.\n");
+        fprintf(stderr, "error (cml_matrix_view): the row step should be positive.\n");
+        return NULL;
+    }
+    if ((m > 0 && i + (m - 1) * step >= a->m) || j + n > a->n)
+    {
+        fprintf(stderr, "error (cml_matrix_view): the block (%ld, %ld) at (%ld, %ld) with step %ld is outside of the matrix dimension (%ld, %ld).\n", m, n, i, j, step, a->m, a->n);
         return NULL;
     }
+    // writes to the view must reach A alone, and later copies of A must not be shared
+    struct matrix *parent = (((struct matrix *)a)->parent != NULL) ? ((struct matrix *)a)->parent : (struct matrix *)a;
+    if (matrix_unshare(&parent->pub, true) == NULL)
+        return NULL;
+    parent->viewed = true;
+    struct matrix *view = (struct matrix *)matrix_aligned_alloc(CML_MATRIX_ALIGN, sizeof(*view));
+    if (view == NULL)
+        return NULL;
+    matrix_init(view, m, n, a->dtype, matrix_ptr(a, i, j), step * matrix_ld(a));
+    view->parent = parent;
+    return &view->pub;
+}
 
-    cml_matrix *ainv = cml_matrix_eye(a->m);
-    if (ainv == NULL)
+cml_matrix *cml_matrix_view_rows(cml_matrix *const a, const lgint i, const lgint m)
+{
+    if (a == NULL)
     {
-        fprintf(stderr, "error (matrix_inv): the allocation memory has failed.");
+        fprintf(stderr, "error (cml_matrix_view_rows): the matrix is null.\n");
         return NULL;
     }
+    return cml_matrix_view(a, i, 0, m, a->n, 1);
+}
 
-    cml_matrix *b = a->copy(a);
-    if (b == NULL)
+// header of the matrix over the caller's elements, on behalf of `caller`
+static cml_matrix *matrix_wrap(void *data, const lgint m, const lgint n, const lgint ld, const cml_dtype dtype,
+                               cml_matrix_deleter *deleter, void *ctx, const char *caller)
+{
+    const size_t elsize = (dtype == FLOAT32) ? sizeof(float) : sizeof(fdouble);
+    if (data == NULL || (uintptr_t)data % elsize != 0)
+    {
+        fprintf(stderr, "error (%s): the elements are null or not aligned on their type.\n", caller);
+        return NULL;
+    }
+    if (ld != 0 && ld < n)
+    {
+        fprintf(stderr, "error (%s): the leading dimension %ld is smaller than the number of columns %ld.\n", caller, ld, n);
+        return NULL;
+    }
+    struct matrix *mat = (struct matrix *)matrix_aligned_alloc(CML_MATRIX_ALIGN, sizeof(*mat));
+    if (mat == NULL)
     {
-        fprintf(stderr, "error (matrix_inv) - the allocation memory has failed.");
-        ainv->free(&ainv);
+        fprintf(stderr, "error (%s): the allocation memory has failed.\n", caller);
+        return NULL;
+    }
+    matrix_init(mat, m, n, dtype, data, (ld == 0) ? n : ld);
+    mat->wrapped = true;
+    mat->deleter = deleter;
+    mat->deleter_ctx = ctx;
+    return &mat->pub;
+}
+
+cml_matrix *cml_matrix_wrap(fdouble *data, const lgint m, const lgint n, const lgint ld, cml_matrix_deleter *deleter, void *ctx)
+{
+    return matrix_wrap(data, m, n, ld, FLOAT64, deleter, ctx, "cml_matrix_wrap");
+}
+
+cml_matrix *cml_matrix_wrap_f32(float *data, const lgint m, const lgint n, const lgint ld, cml_matrix_deleter *deleter, void *ctx)
+{
+    return matrix_wrap(data, m, n, ld, FLOAT32, deleter, ctx, "cml_matrix_wrap_f32");
+}
+
+cml_matrix *cml_matrix_zeros(const lgint m, const lgint n)
+{
+    return matrix_create(NULL, m, n, n, FLOAT64, true);
+}
+
+cml_matrix *cml_matrix_zeros_dtype(const lgint m, const lgint n, const cml_dtype dtype)
+{
+    return matrix_create(NULL, m, n, n, dtype, true);
+}
+
+cml_matrix *matrix_copy(cml_matrix *const a)
+{
+    if (a == NULL)
         return NULL;
+    struct matrix *mat = (struct matrix *)a;
+    // views, matrices with views, those of an allocator and the caller's elements are copied at once
+    if (mat->parent != NULL || mat->viewed || mat->allocator != NULL || mat->wrapped)
+    {
+        cml_matrix *out = cml_matrix_alloc_dtype(a->m, a->n, a->dtype);
+        return matrix_or_free(cml_matrix_copy_into(a, out), out);
     }
-    cml_matrix *mts[] = {b, ainv};
 
-    for (lgint i = 0; i < b->m; i++)
+    struct matrix *copy = (struct matrix *)matrix_aligned_alloc(CML_MATRIX_ALIGN, sizeof(*copy));
+    if (copy == NULL)
+    {
+        fprintf(stderr, "error (matrix_copy): the allocation memory has failed.\n");
+        return NULL;
+    }
+    if (mat->shared == NULL && mat->home != NULL && mat->buffer == NULL)
+    {
+        // elements taken back into the block after an earlier copy, shared again
+        mat->shared = mat->home;
+        __atomic_add_fetch(&mat->shared->refs, 1, __ATOMIC_RELAXED);
+    }
+    else if (mat->shared == NULL)
     {
-        const lgint pivot = matrix_get_pivot(b, i);
-        if (pivot != i)
+        struct matrix_storage *storage = (struct matrix_storage *)malloc(sizeof(*storage));
+        if (storage == NULL)
         {
-            matrix_pivoting(mts, 2, pivot, i);
+            fprintf(stderr, "error (matrix_copy): the allocation memory has failed.\n");
+            free(copy);
+            return NULL;
         }
-        fdouble coef = b->get(b, i, i);
-        if (fabs(coef) < CML_MATRIX_TOLERANCE)
+        if (mat->buffer == NULL)
         {
-            ainv->free(&ainv);
-            b->free(&b);
-            fprintf(stderr, "error (matrix_inv) - the matrix is singular - it can not be inverted.\n");
-            return NULL;
+            // elements in the block of the header, freed once both the header and the copies are gone
+            *storage = (struct matrix_storage){2, mat, NULL};
+            mat->home = storage;
         }
         else
         {
-            matrix_linear_oper(mts, 2, i, 1 / coef, i, 0., 0);
-            for (lgint it = 0; it < b->m; it++)
-            {
-                if (it == i)
-                    continue;
-
-                const fdouble coef_j = b->get(b, it, i);
-                const fdouble coef_k = b->get(b, i, i);
-
-                matrix_linear_oper(mts, 2, it, -coef_j, i, coef_k, it);
-            }
+            *storage = (struct matrix_storage){1, NULL, mat->buffer};
+            mat->buffer = NULL;
         }
+        mat->shared = storage;
     }
-    b->free(&b);
-    return ainv;
+    __atomic_add_fetch(&mat->shared->refs, 1, __ATOMIC_RELAXED);
+
+    // the elements are copied by the first write to either matrix, see matrix_unshare
+    matrix_init(copy, a->m, a->n, a->dtype, a->data, matrix_ld(a));
+    copy->shared = mat->shared;
+    return &copy->pub;
 }
 
-lgint cml_lu(cml_matrix *const a, cml_matrix **p, cml_matrix **l, cml_matrix **u)
+fdouble matrix_det(cml_matrix *const a)
 {
     if (a == NULL)
     {
-        fprintf(stderr, "error (cml_lu): the matrix is null.\n");
-        return 0;
+        fprintf(stderr, "error (matrix_det): the matrix is null.\n");
+        return DBL_MAX;
     }
-    if (a->m != a->n)
+    if (a->m == a->n && a->m == 1)
+        return matrix_load(a, 0, 0);
+
+    cml_lu *lu = cml_lu_create(a);
+    if (lu == NULL)
+        return 0.;
+    const fdouble det = lu->det(lu);
+    lu->free(&lu);
+    return det;
+}
+
+void matrix_free(cml_matrix **a)
+{
+    if (*a == NULL)
+        return;
+    struct matrix *mat = (struct matrix *)*a;
+    if (mat->allocator != NULL)
     {
-        fprintf(stderr, "error (cml_lu): the matrix should be square.\n");
-        return 0;
+        mat->allocator->dealloc(mat->allocator, mat, mat->size);
     }
-    lgint i, j, k;
-    //  initialize permutation matrix `p`, `l` and `u`
-    *p = cml_matrix_eye(a->m);
-    *l = cml_matrix_zeros(a->m, a->n);
-    *u = a->copy(a);
-
-    lgint permutations = 0;
-    for (i = 0; i < (*u)->m; i++)
+    else
     {
-        const lgint pivot = matrix_get_pivot(*u, i);
+        if (mat->shared != NULL)
+            matrix_storage_release(mat->shared);
+        free(mat->buffer);
+        if (mat->deleter != NULL)
+            mat->deleter(mat->pub.data, mat->deleter_ctx);
+        // a header whose elements have been shared lives in a block freed with the last copy
+        if (mat->home != NULL)
+            matrix_storage_release(mat->home);
+        else
+            free(mat);
+    }
+    *a = NULL;
+}
 
-        // swap rows pivot and `i`
-        if (pivot != i)
-        {
-            cml_matrix *at[] = {*p, *l, *u};
-            matrix_pivoting(at, 3, pivot, i);
-            permutations++;
-        }
+fdouble matrix_get(cml_matrix *const a, const lgint i, const lgint j)
+{
+    if (a == NULL)
+        return DBL_MAX;
+    if (a->m <= i || a->n <= j)
+    {
+        fprintf(stderr, "Error (matrix_get): the index (%ld, %ld) is outside of the matrix dimension (%ld, %ld)\n", i, j, a->m, a->n);
+        return DBL_MAX;
+    }
+    return matrix_load(a, i, j);
+}
 
-        // perform the decomposition
-        for (j = i + 1; j < a->m; j++)
-        {
-            const fdouble coef = (*u)->get(*u, i, i);
-            if (fabs(coef) < CML_MATRIX_TOLERANCE)
-            {
-                fprintf(stderr, "error (cml_lu): the matrix is singular.\n");
-                (*p)->free(p);
-                (*l)->free(l);
-                (*u)->free(u);
-                return 0;
-            }
-            (*l)->set(l, j, i, (*u)->get(*u, j, i) / coef);
-            for (k = i; k < a->m; k++)
-            {
-                (*u)->set(u, j, k, (*u)->get(*u, j, k) - (*l)->get(*l, j, i) * (*u)->get(*u, i, k));
-            }
-        }
+cml_matrix *matrix_hadamard(cml_matrix *const a, cml_matrix *const b)
+{
+    if (a->m != b->m || a->n != b->n)
+    {
+        fprintf(stderr, "Error (matrix_hadamard): the matrices are not element-wise product.\n");
+        return NULL;
     }
+    cml_matrix *out = cml_matrix_alloc_dtype(a->m, a->n, a->dtype);
+    return matrix_or_free(cml_matrix_hadamard_into(a, b, out), out);
+}
 
-    // check last row
-    bool is_zeros = true;
-    for (j = 0; j < (*u)->n; j++)
+cml_matrix *matrix_inv(cml_matrix *const a)
+{
+    if (a == NULL)
     {
-        if (fabs((*u)->get(*u, (*u)->m - 1, j)) > CML_MATRIX_TOLERANCE)
-        {
-            is_zeros = false;
-            break;
-        }
+        fprintf(stderr, "error (matrix_inv): the matrix is null.\n");
+        return NULL;
     }
-    if (is_zeros)
+    if (a->m != a->n)
     {
-        fprintf(stderr, "error (cml_lu): the matrix is singular.\n");
-        (*p)->free(p);
-        (*l)->free(l);
-        (*u)->free(u);
-        return 0;
+        fprintf(stderr, "error (matrix_inv): the matrix should be square.\n");
+        return NULL;
     }
 
-    // set the diagonal of `l` to 1
-    for (i = 0; i < a->m; i++)
+    cml_lu *lu = cml_lu_create(a);
+    if (lu == NULL)
     {
-        (*l)->set(l, i, i, 1.);
+        fprintf(stderr, "error (matrix_inv) - the matrix is singular - it can not be inverted.\n");
+        return NULL;
     }
-
-    return permutations;
+    cml_matrix *ainv = lu->inv(lu);
+    lu->free(&lu);
+    return ainv;
 }
 
 void matrix_lu(cml_matrix *const a, cml_matrix **p, cml_matrix **l, cml_matrix **u)
 {
-    cml_lu(a, p, l, u);
+    *p = *l = *u = NULL;
+    cml_lu *lu = cml_lu_create(a);
+    if (lu == NULL)
+        return;
+    lu->unpack(lu, p, l, u);
+    lu->free(&lu);
 }
 
 cml_matrix *matrix_normalize(cml_matrix *const a)
@@ -526,31 +1250,8 @@ cml_matrix *matrix_normalize(cml_matrix *const a)
     if (a == NULL)
         return NULL;
 
-    cml_matrix *a_norm = cml_matrix_alloc(a->m, a->n);
-    for (lgint j = 0; j < a->n; j++)
-    {
-        // get the max of jth column
-        lgint i_max = 0;
-        fdouble fmax = DBL_MIN;
-        for (lgint i = 0; i < a->m; i++)
-        {
-            if (fmax < a->get(a, i, j))
-            {
-                fmax = a->get(a, i, j);
-                i_max = i;
-            }
-        }
-        // divide by the max
-        const fdouble coef = a->get(a, i_max, j);
-        if (coef != 0)
-        {
-            for (lgint i = 0; i < a_norm->m; i++)
-            {
-                a_norm->set(&a_norm, i, j, a->get(a, i, j) / coef);
-            }
-        }
-    }
-    return a_norm;
+    cml_matrix *out = cml_matrix_alloc_dtype(a->m, a->n, a->dtype);
+    return matrix_or_free(cml_matrix_normalize_into(a, out), out);
 }
 
 void matrix_print(cml_matrix *const a)
@@ -565,9 +1266,9 @@ void matrix_print(cml_matrix *const a)
         for (lgint j = 0; j < a->n; j++)
         {
             if (j == 0)
-                printf("%lg", a->get(a, i, j));
+                printf("%lg", matrix_load(a, i, j));
             else
-                printf(", %lg", a->get(a, i, j));
+                printf(", %lg", matrix_load(a, i, j));
         }
         printf("]\n");
     }
@@ -583,31 +1284,34 @@ void matrix_set(cml_matrix **a, const lgint i, const lgint j, const fdouble valu
         fprintf(stderr, "Error (matrix_set): the index (%ld, %ld) is outside of the matrix dimension (%ld, %ld)\n", i, j, (*a)->m, (*a)->n);
         return;
     }
-    struct matrix *mat = (struct matrix *)(*a);
-    mat->data[i * (*a)->n + j] = value;
+    if (matrix_unshare(*a, true) == NULL)
+        return;
+    matrix_store(*a, i, j, value);
 }
 
 void matrix_softmax(cml_matrix **a)
 {
+    if (*a == NULL || (*a)->m == 0 || (*a)->n == 0)
+        return;
+
+    // one-hot row of the largest element of each row
+    cml_matrix *index = cml_matrix_alloc_dtype((*a)->m, 1, (*a)->dtype);
+    index = matrix_or_free(cml_matrix_reduce_rows(REDUCE_ARGMAX, *a, index), index);
+    if (index == NULL || matrix_unshare(*a, false) == NULL)
+    {
+        if (index != NULL)
+            index->vt->free(&index);
+        return;
+    }
     for (lgint i = 0; i < (*a)->m; i++)
     {
-        lgint index = 0;
-        fdouble fmax = DBL_MIN;
+        const lgint k = (lgint)matrix_load(index, i, 0);
         for (lgint j = 0; j < (*a)->n; j++)
         {
-            const fdouble aij = (*a)->get(*a, i, j);
-            if (fmax < aij)
-            {
-                fmax = aij;
-                index = j;
-            }
-        }
-
-        for (lgint j = 0; j < (*a)->n; j++)
-        {
-            (*a)->set(a, i, j, index == j);
+            matrix_store(*a, i, j, k == j);
         }
     }
+    index->vt->free(&index);
 }
 
 fdouble matrix_trace(cml_matrix *const a)
@@ -618,7 +1322,7 @@ fdouble matrix_trace(cml_matrix *const a)
     const lgint n = (a->m < a->n) ? a->m : a->n;
     for (lgint i = 0; i < n; i++)
     {
-        trace += a->get(a, i, i);
+        trace += matrix_load(a, i, i);
     }
     return trace;
 }
@@ -628,17 +1332,26 @@ void matrix_transpose(cml_matrix *const a, cml_matrix **at)
     if (a == NULL)
         return;
     if (*at == NULL)
-        *at = cml_matrix_alloc(a->n, a->m);
-    if ((*at)->m != a->n || (*at)->n != a->m)
+        *at = cml_matrix_alloc_dtype(a->n, a->m, a->dtype);
+    if ((*at)->m != a->n || (*at)->n != a->m || (*at)->dtype != a->dtype)
     {
-        fprintf(stderr, "error (matrix_transpose): the matrix transpose has bad dimension.\n");
+        fprintf(stderr, "error (matrix_transpose): the matrix transpose has bad dimension or dtype.\n");
         return;
     }
-    for (lgint i = 0; i < (*at)->m; i++)
+    // in place for A itself only
+    if (*at != a && matrix_overlap(*at, a))
     {
-        for (lgint j = 0; j < (*at)->n; j++)
-        {
-            (*at)->set(at, i, j, a->get(a, j, i));
-        }
+        fprintf(stderr, "error (matrix_transpose): the matrix transpose can not overlap A unless it is A.\n");
+        return;
     }
-}
\ No newline at end of file
+    if (matrix_unshare(*at, *at == a) == NULL)
+        return;
+    if (*at == a && a->dtype == FLOAT32)
+        cml_transpose_square_f32(a->m, matrix_data_f32(a), matrix_ld(a));
+    else if (*at == a)
+        cml_transpose_square(a->m, matrix_data(a), matrix_ld(a));
+    else if (a->dtype == FLOAT32)
+        cml_transpose_f32(a->m, a->n, matrix_data_f32(a), matrix_ld(a), matrix_data_f32(*at), matrix_ld(*at));
+    else
+        cml_transpose(a->m, a->n, matrix_data(a), matrix_ld(a), matrix_data(*at), matrix_ld(*at));
+}
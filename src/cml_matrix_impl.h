@@ -0,0 +1,144 @@
+#ifndef cml_matrix_impl_h
+#define cml_matrix_impl_h
+
+#include "cml_matrix.h"
+
+#include <stdint.h>
+
+// alignment in bytes of the header and of the elements of a matrix, a cache line
+#define CML_MATRIX_ALIGN 64
+
+// size in bytes above which the elements are allocated apart on huge pages
+#define CML_MATRIX_HUGEPAGE_SIZE (4 << 20)
+
+// elements shared by the copies of a matrix, freed with the last of them
+struct matrix_storage
+{
+    /* Number of matrices reading the elements, plus one for a block whose header is alive */
+    lgint refs;
+
+    /* Block holding a header and the elements, and elements allocated apart, either one NULL */
+    void *block;
+    void *buffer;
+};
+
+struct matrix
+{
+    /* Public interface */
+    cml_matrix pub;
+
+    /* Elements allocated apart from the header (large matrices or unshared copies), NULL otherwise */
+    void *buffer;
+
+    /* Storage of the elements while they are shared with copies, NULL when they are the matrix's own */
+    struct matrix_storage *shared;
+
+    /* Storage that frees the block of this header once its elements have been shared, NULL otherwise */
+    struct matrix_storage *home;
+
+    /* Matrix whose elements a view reads, and whether views of this matrix were taken (its copies are then eager) */
+    struct matrix *parent;
+    bool viewed;
+
+    /* Whether the elements belong to the caller (cml_matrix_wrap), and the release of them with its context */
+    bool wrapped;
+    cml_matrix_deleter *deleter;
+    void *deleter_ctx;
+
+    /* Allocator of the block holding header and elements and its size, NULL for the system */
+    cml_allocator *allocator;
+    size_t size;
+
+    /* Placeholder for data, on a cache line boundary */
+    fdouble data[] __attribute__((aligned(CML_MATRIX_ALIGN)));
+};
+
+// matrix (m, n) with rows `ld` >= n elements apart, zero filled when `zero` is set,
+// drawn from `allocator` or from the system when it is NULL
+cml_matrix *matrix_create(cml_allocator *const allocator, const lgint m, const lgint n, const lgint ld, const cml_dtype dtype, const bool zero);
+
+/*
+ * Copy-on-write: no other matrix reads the elements of A when this
+ * returns, and any function writing to the elements of a matrix calls it
+ * first. The
+ * shared elements are copied when `keep` is set, otherwise the new ones are
+ * left uninitialized for a result that overwrites them all. Returns A
+ * (NULL when the allocation has failed).
+ */
+cml_matrix *matrix_unshare_slow(cml_matrix *const a, const bool keep);
+
+static inline cml_matrix *matrix_unshare(cml_matrix *const a, const bool keep)
+{
+    return (((struct matrix *)a)->shared == NULL) ? a : matrix_unshare_slow(a, keep);
+}
+
+// double-precision copy of A with padded rows, the working copy of the factorizations
+cml_matrix *matrix_copy_f64(cml_matrix *const a);
+
+// A itself when it is of type `dtype`, otherwise a converted copy and A is freed
+cml_matrix *matrix_cast_free(cml_matrix *a, const cml_dtype dtype);
+
+// row-major elements of the FLOAT64 matrix `a`, the row stride is `matrix_ld(a)`
+static inline fdouble *matrix_data(cml_matrix *const a)
+{
+    return (fdouble *)a->data;
+}
+
+// row-major elements of the FLOAT32 matrix `a`
+static inline float *matrix_data_f32(cml_matrix *const a)
+{
+    return (float *)a->data;
+}
+
+// distance between two rows of `a`, `a->n` unless `a` is a view or padded
+static inline lgint matrix_ld(cml_matrix *const a)
+{
+    return a->ld;
+}
+
+// whether the rows of `a` follow each other in memory
+static inline bool matrix_is_contiguous(cml_matrix *const a)
+{
+    return a->m <= 1 || matrix_ld(a) == a->n;
+}
+
+// size in bytes of one element of `a`
+static inline size_t matrix_elsize(cml_matrix *const a)
+{
+    return (a->dtype == FLOAT32) ? sizeof(float) : sizeof(fdouble);
+}
+
+// address of the element (i, j) of `a`, whatever its type
+static inline char *matrix_ptr(cml_matrix *const a, const lgint i, const lgint j)
+{
+    return (char *)a->data + (i * matrix_ld(a) + j) * matrix_elsize(a);
+}
+
+// whether writing to the elements of `a` may change those of `b`: A is B,
+// or the ranges from the first to the last element of each intersect, e.g.
+// two views of one matrix at different offsets. Elements A still shares
+// with copies are not counted, they are copied on the first write.
+static inline bool matrix_overlap(cml_matrix *const a, cml_matrix *const b)
+{
+    if (a == b)
+        return true;
+    if (((struct matrix *)a)->shared != NULL || a->m == 0 || a->n == 0 || b->m == 0 || b->n == 0)
+        return false;
+    const uintptr_t a0 = (uintptr_t)a->data, a1 = (uintptr_t)matrix_ptr(a, a->m - 1, a->n);
+    const uintptr_t b0 = (uintptr_t)b->data, b1 = (uintptr_t)matrix_ptr(b, b->m - 1, b->n);
+    return a0 < b1 && b0 < a1;
+}
+
+// unchecked read and write of the element (i, j), converted from/to fdouble
+// (checked in a CML_CHECKED build)
+static inline fdouble matrix_load(cml_matrix *const a, const lgint i, const lgint j)
+{
+    return cml_matrix_load(a, i, j);
+}
+
+static inline void matrix_store(cml_matrix *const a, const lgint i, const lgint j, const fdouble value)
+{
+    cml_matrix_store(a, i, j, value);
+}
+
+#endif
@@ -0,0 +1,270 @@
+#include "cml_pca.h"
+#include "cml_cholesky.h"
+#include "cml_eigen.h"
+#include "cml_matrix_impl.h"
+#include "cml_simd.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// number of columns up to which the components come from the covariance matrix
+#define PCA_COVARIANCE_MAX_COLUMNS 512
+
+struct pca
+{
+    /* Public interface */
+    cml_pca pub;
+
+    /* Row -mean*C^T starting each projection, and the single-precision copies */
+    cml_matrix *shift;
+    cml_matrix *components_f32, *mean_f32, *shift_f32;
+};
+
+static void pca_fit(cml_pca *const pca, cml_matrix *const x);
+static void pca_free(cml_pca **pca);
+static cml_matrix *pca_inverse_transform(cml_pca *const pca, cml_matrix *const z);
+static cml_matrix *pca_transform(cml_pca *const pca, cml_matrix *const x);
+
+static void pca_set(cml_matrix *const *field, cml_matrix *value)
+{
+    *(cml_matrix **)field = value;
+}
+
+// back to the state of an unfitted analysis
+static void pca_release(struct pca *pca)
+{
+    cml_matrix **owned[] = {(cml_matrix **)&pca->pub.components, (cml_matrix **)&pca->pub.explained_variance,
+                            (cml_matrix **)&pca->pub.explained_variance_ratio, (cml_matrix **)&pca->pub.mean,
+                            &pca->shift, &pca->components_f32, &pca->mean_f32, &pca->shift_f32};
+    for (size_t t = 0; t < sizeof(owned) / sizeof(*owned); t++)
+    {
+        if (*owned[t] != NULL)
+            (*owned[t])->vt->free(owned[t]);
+    }
+    *(lgint *)(&pca->pub.n) = 0;
+}
+
+cml_pca *cml_pca_create(const lgint k)
+{
+    if (k == 0)
+    {
+        fprintf(stderr, "error (cml_pca_create): the number of components should be positive.\n");
+        return NULL;
+    }
+    struct pca *pca = (struct pca *)calloc(1, sizeof(*pca));
+    if (pca == NULL)
+    {
+        fprintf(stderr, "error (cml_pca_create): the allocation memory has failed.\n");
+        return NULL;
+    }
+    *(lgint *)(&pca->pub.k) = k;
+
+    pca->pub.fit = &pca_fit;
+    pca->pub.free = &pca_free;
+    pca->pub.inverse_transform = &pca_inverse_transform;
+    pca->pub.transform = &pca_transform;
+
+    return &pca->pub;
+}
+
+// components C(k, n) in rows and their variances of the centered X(m, n),
+// from the eigenvectors of the covariance X^T*X/(m - 1)
+static bool pca_covariance(cml_matrix *x, cml_matrix *c, fdouble *variance)
+{
+    const lgint n = x->n, k = c->m;
+    cml_matrix *cov = cml_matrix_alloc(n, n);
+    fdouble *w = (fdouble *)malloc(n * sizeof(*w));
+    bool ok = (cov != NULL && w != NULL);
+    if (ok)
+    {
+        // syrk fills the upper triangle, the eigensolver reads the lower one
+        fdouble *a = matrix_data(cov);
+        cml_syrk(n, x->m, 1. / (x->m - 1), matrix_data(x), matrix_ld(x), 0., a, n);
+        for (lgint i = 1; i < n; i++)
+        {
+            for (lgint j = 0; j < i; j++)
+            {
+                a[i * n + j] = a[j * n + i];
+            }
+        }
+        ok = cml_syev(n, a, n, w);
+    }
+    for (lgint i = 0; ok && i < k; i++)
+    {
+        memcpy(matrix_ptr(c, i, 0), matrix_ptr(cov, i, 0), n * sizeof(fdouble));
+        variance[i] = fmax(w[i], 0.);
+    }
+    if (cov != NULL)
+        cov->vt->free(&cov);
+    free(w);
+    return ok;
+}
+
+// components C(k, n) in rows and their variances of the centered X(m, n),
+// from its truncated SVD X ~ U*diag(s)*C
+static bool pca_svd(cml_matrix *x, cml_matrix *c, fdouble *variance)
+{
+    const lgint m = x->m, k = c->m;
+    fdouble *u = (fdouble *)malloc(m * k * sizeof(*u));
+    bool ok = (u != NULL && cml_rsvd(m, x->n, k, matrix_data(x), matrix_ld(x), u, variance, matrix_data(c)));
+    for (lgint i = 0; ok && i < k; i++)
+    {
+        variance[i] = variance[i] * variance[i] / (m - 1);
+    }
+    free(u);
+    return ok;
+}
+
+void pca_fit(cml_pca *const self, cml_matrix *const x)
+{
+    if (self == NULL)
+        return;
+    struct pca *pca = (struct pca *)self;
+    pca_release(pca);
+    if (x == NULL)
+    {
+        fprintf(stderr, "error (pca_fit): the matrix X is null.\n");
+        return;
+    }
+    const lgint m = x->m, n = x->n, k = self->k;
+    if (k > n || k >= m)
+    {
+        fprintf(stderr, "error (pca_fit): the matrix X (%ld, %ld) should have at least %ld columns and %ld rows.\n", m, n, k, k + 1);
+        return;
+    }
+
+    // centered copy of X
+    cml_matrix *xc = matrix_copy_f64(x);
+    pca_set(&self->mean, cml_matrix_alloc(1, n));
+    pca_set(&self->components, cml_matrix_alloc(k, n));
+    pca_set(&self->explained_variance, cml_matrix_alloc(k, 1));
+    pca_set(&self->explained_variance_ratio, cml_matrix_alloc(k, 1));
+    pca->shift = cml_matrix_alloc(1, k);
+    bool ok = (xc != NULL && self->mean != NULL && self->components != NULL && self->explained_variance != NULL &&
+               self->explained_variance_ratio != NULL && pca->shift != NULL &&
+               cml_matrix_reduce_columns(REDUCE_MEAN, xc, self->mean) != NULL);
+    fdouble total = 0.;
+    for (lgint i = 0; ok && i < m; i++)
+    {
+        fdouble *row = (fdouble *)matrix_ptr(xc, i, 0);
+        cml_vec_sub(n, row, matrix_data(self->mean), row);
+        total += cml_vec_dot(n, row, row);
+    }
+    total /= (m - 1);
+
+    // the covariance is cheap for narrow data, and for wide data when most components are kept anyway
+    fdouble *variance = ok ? matrix_data(self->explained_variance) : NULL;
+    if (ok && (n <= PCA_COVARIANCE_MAX_COLUMNS || 4 * k > n))
+        ok = pca_covariance(xc, self->components, variance);
+    else if (ok)
+        ok = pca_svd(xc, self->components, variance);
+    if (xc != NULL)
+        xc->vt->free(&xc);
+    if (!ok)
+    {
+        fprintf(stderr, "error (pca_fit): the allocation memory has failed or the decomposition has not converged.\n");
+        pca_release(pca);
+        return;
+    }
+
+    for (lgint i = 0; i < k; i++)
+    {
+        // deterministic sign, the largest element of the component being positive
+        fdouble *c = (fdouble *)matrix_ptr(self->components, i, 0);
+        const fdouble top = cml_vec_maxval(n, c), bottom = cml_vec_minval(n, c);
+        if (-bottom > top)
+            cml_vec_scale(n, -1., c, c);
+        matrix_store(self->explained_variance_ratio, i, 0, (total > 0.) ? variance[i] / total : 0.);
+        matrix_store(pca->shift, 0, i, -cml_vec_dot(n, c, matrix_data(self->mean)));
+    }
+    pca->components_f32 = cml_matrix_cast(self->components, FLOAT32);
+    pca->mean_f32 = cml_matrix_cast(self->mean, FLOAT32);
+    pca->shift_f32 = cml_matrix_cast(pca->shift, FLOAT32);
+    if (pca->components_f32 == NULL || pca->mean_f32 == NULL || pca->shift_f32 == NULL)
+    {
+        fprintf(stderr, "error (pca_fit): the allocation memory has failed.\n");
+        pca_release(pca);
+        return;
+    }
+    *(lgint *)(&self->n) = n;
+}
+
+void pca_free(cml_pca **self)
+{
+    if (*self == NULL)
+        return;
+    struct pca *pca = (struct pca *)(*self);
+    pca_release(pca);
+    free(pca);
+    *self = NULL;
+}
+
+// every row of OUT <= the row `row` (1, out->n) of the type of OUT
+static void pca_fill(cml_matrix *out, cml_matrix *row)
+{
+    const size_t size = out->n * matrix_elsize(out);
+    for (lgint i = 0; i < out->m; i++)
+    {
+        memcpy(matrix_ptr(out, i, 0), row->data, size);
+    }
+}
+
+cml_matrix *pca_inverse_transform(cml_pca *const self, cml_matrix *const z)
+{
+    if (self == NULL)
+        return NULL;
+    struct pca *pca = (struct pca *)self;
+    if (z == NULL)
+    {
+        fprintf(stderr, "error (pca_inverse_transform): the matrix Z is null.\n");
+        return NULL;
+    }
+    if (self->n == 0)
+    {
+        fprintf(stderr, "error (pca_inverse_transform): the analysis should be fitted first.\n");
+        return NULL;
+    }
+    if (z->n != self->k)
+    {
+        fprintf(stderr, "error (pca_inverse_transform): the matrix Z should have %ld columns.\n", self->k);
+        return NULL;
+    }
+    const bool f32 = (z->dtype == FLOAT32);
+    cml_matrix *out = cml_matrix_alloc_dtype(z->m, self->n, z->dtype);
+    if (out == NULL)
+        return NULL;
+    // X = mean + Z*C
+    pca_fill(out, f32 ? pca->mean_f32 : self->mean);
+    return cml_matrix_gemm(false, false, 1., z, f32 ? pca->components_f32 : self->components, 1., out);
+}
+
+cml_matrix *pca_transform(cml_pca *const self, cml_matrix *const x)
+{
+    if (self == NULL)
+        return NULL;
+    struct pca *pca = (struct pca *)self;
+    if (x == NULL)
+    {
+        fprintf(stderr, "error (pca_transform): the matrix X is null.\n");
+        return NULL;
+    }
+    if (self->n == 0)
+    {
+        fprintf(stderr, "error (pca_transform): the analysis should be fitted first.\n");
+        return NULL;
+    }
+    if (x->n != self->n)
+    {
+        fprintf(stderr, "error (pca_transform): the matrix X should have %ld columns.\n", self->n);
+        return NULL;
+    }
+    const bool f32 = (x->dtype == FLOAT32);
+    cml_matrix *out = cml_matrix_alloc_dtype(x->m, self->k, x->dtype);
+    if (out == NULL)
+        return NULL;
+    // Z = X*C^T - mean*C^T, X is not centered
+    pca_fill(out, f32 ? pca->shift_f32 : pca->shift);
+    return cml_matrix_gemm(false, true, 1., x, f32 ? pca->components_f32 : self->components, 1., out);
+}
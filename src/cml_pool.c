@@ -0,0 +1,220 @@
+#include "cml_parallel.h"
+#include "cml_pool.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// chunks handed out per thread, more than one to even out the load
+#define POOL_CHUNKS_PER_THREAD 4
+
+struct pool
+{
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+
+    pthread_t *workers;
+    lgint n_workers;
+    lgint n_threads;
+    unsigned long generation;
+    bool stop;
+
+    /* Current job */
+    cml_pool_task *task;
+    void *ctx;
+    lgint n;
+    lgint chunk;
+    lgint next;
+    lgint busy;
+};
+
+static struct pool pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+// held by the thread submitting a job, also serializes resizing
+static pthread_mutex_t pool_owner = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+static __thread bool pool_in_task = false;
+
+static lgint pool_default_threads(void)
+{
+    const char *env = getenv("CML_NUM_THREADS");
+    if (env != NULL)
+    {
+        const long n = strtol(env, NULL, 10);
+        if (n > 0)
+            return n;
+        fprintf(stderr, "error (cml_get_num_threads): CML_NUM_THREADS=%s is not a positive number.\n", env);
+    }
+    const long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? n : 1;
+}
+
+static void pool_init(void)
+{
+    __atomic_store_n(&pool.n_threads, pool_default_threads(), __ATOMIC_RELAXED);
+}
+
+static void pool_work(void)
+{
+    for (;;)
+    {
+        const lgint begin = __atomic_fetch_add(&pool.next, pool.chunk, __ATOMIC_RELAXED);
+        if (begin >= pool.n)
+            break;
+        const lgint end = (begin + pool.chunk < pool.n) ? begin + pool.chunk : pool.n;
+        pool.task(pool.ctx, begin, end);
+    }
+}
+
+static void *pool_worker(void *arg)
+{
+    unsigned long seen = (unsigned long)(uintptr_t)arg;
+    pool_in_task = true;
+
+    pthread_mutex_lock(&pool.lock);
+    for (;;)
+    {
+        while (!pool.stop && pool.generation == seen)
+            pthread_cond_wait(&pool.wake, &pool.lock);
+        if (pool.stop)
+            break;
+        seen = pool.generation;
+        pthread_mutex_unlock(&pool.lock);
+
+        pool_work();
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.busy == 0)
+            pthread_cond_signal(&pool.done);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+// start the workers if needed, the caller holds `pool_owner`
+static void pool_start(void)
+{
+    pthread_once(&pool_once, &pool_init);
+    if (pool.workers != NULL || pool.n_threads <= 1)
+        return;
+
+    pool.workers = (pthread_t *)malloc((pool.n_threads - 1) * sizeof(*pool.workers));
+    if (pool.workers == NULL)
+        return;
+
+    pthread_mutex_lock(&pool.lock);
+    const unsigned long generation = pool.generation;
+    pthread_mutex_unlock(&pool.lock);
+    for (lgint i = 0; i < pool.n_threads - 1; i++)
+    {
+        if (pthread_create(&pool.workers[i], NULL, &pool_worker, (void *)(uintptr_t)generation) != 0)
+        {
+            fprintf(stderr, "error (cml_pool_run): only %ld worker threads could be started.\n", i);
+            break;
+        }
+        pool.n_workers++;
+    }
+}
+
+// join the workers, the caller holds `pool_owner`
+static void pool_stop(void)
+{
+    if (pool.workers == NULL)
+        return;
+
+    pthread_mutex_lock(&pool.lock);
+    pool.stop = true;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    for (lgint i = 0; i < pool.n_workers; i++)
+    {
+        pthread_join(pool.workers[i], NULL);
+    }
+    free(pool.workers);
+    pool.workers = NULL;
+    pool.n_workers = 0;
+    pool.stop = false;
+}
+
+__attribute__((destructor)) static void pool_fini(void)
+{
+    pthread_mutex_lock(&pool_owner);
+    pool_stop();
+    pthread_mutex_unlock(&pool_owner);
+}
+
+void cml_pool_run(const lgint n, const lgint grain, cml_pool_task *task, void *ctx)
+{
+    if (n <= 0)
+        return;
+    if (pool_in_task || n <= grain || pthread_mutex_trylock(&pool_owner) != 0)
+    {
+        task(ctx, 0, n);
+        return;
+    }
+
+    pool_start();
+    if (pool.n_workers == 0)
+    {
+        pthread_mutex_unlock(&pool_owner);
+        task(ctx, 0, n);
+        return;
+    }
+
+    lgint chunk = (n + POOL_CHUNKS_PER_THREAD * (pool.n_workers + 1) - 1) / (POOL_CHUNKS_PER_THREAD * (pool.n_workers + 1));
+    if (chunk < grain)
+        chunk = grain;
+
+    pthread_mutex_lock(&pool.lock);
+    pool.task = task;
+    pool.ctx = ctx;
+    pool.n = n;
+    pool.chunk = chunk;
+    pool.next = 0;
+    pool.busy = pool.n_workers;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    pool_in_task = true;
+    pool_work();
+    pool_in_task = false;
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.busy > 0)
+        pthread_cond_wait(&pool.done, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+
+    pthread_mutex_unlock(&pool_owner);
+}
+
+void cml_set_num_threads(const lgint n)
+{
+    pthread_once(&pool_once, &pool_init);
+    pthread_mutex_lock(&pool_owner);
+    pool_stop();
+    __atomic_store_n(&pool.n_threads, (n > 0) ? n : pool_default_threads(), __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&pool_owner);
+}
+
+lgint cml_get_num_threads(void)
+{
+    pthread_once(&pool_once, &pool_init);
+    return __atomic_load_n(&pool.n_threads, __ATOMIC_RELAXED);
+}
+
+lgint cml_pool_size(void)
+{
+    return pool_in_task ? 1 : cml_get_num_threads();
+}
@@ -0,0 +1,18 @@
+#ifndef cml_pool_h
+#define cml_pool_h
+
+#include "cml_matrix.h"
+
+// run the iterations [begin, end) of a parallel loop
+typedef void cml_pool_task(void *ctx, const lgint begin, const lgint end);
+
+// Split [0, n) into chunks of at least `grain` iterations and run them on the
+// persistent worker pool, the calling thread included. The call returns when
+// every chunk is done. It runs serially when the pool is single-threaded,
+// busy with another caller, or when called from inside a task.
+void cml_pool_run(const lgint n, const lgint grain, cml_pool_task *task, void *ctx);
+
+// number of threads a kernel started from the calling thread can use
+lgint cml_pool_size(void);
+
+#endif
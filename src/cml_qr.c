@@ -0,0 +1,169 @@
+#include "cml_qr.h"
+#include "cml_gemm.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// number of reflectors gathered in one block I - V*T*V^T
+#define QR_BLOCK 32
+
+// reflectors of the columns of the (m, nb) panel A, applied to the panel only
+static void qr_panel(const lgint m, const lgint nb, fdouble *a, const lgint lda, fdouble *tau, fdouble *w)
+{
+    for (lgint j = 0; j < nb && j < m; j++)
+    {
+        // H_j*x = beta*e_1 for the column x = A[j:m, j]
+        const fdouble alpha = a[j * lda + j];
+        fdouble sigma = 0.;
+        for (lgint i = j + 1; i < m; i++)
+        {
+            sigma += a[i * lda + j] * a[i * lda + j];
+        }
+        if (sigma == 0.)
+        {
+            tau[j] = 0.;
+            continue;
+        }
+        const fdouble beta = (alpha >= 0.) ? -sqrt(alpha * alpha + sigma) : sqrt(alpha * alpha + sigma);
+        tau[j] = (beta - alpha) / beta;
+        const fdouble scale = 1. / (alpha - beta);
+        for (lgint i = j + 1; i < m; i++)
+        {
+            a[i * lda + j] *= scale;
+        }
+        a[j * lda + j] = beta;
+
+        // A[j:m, j+1:nb] <= H_j*A[j:m, j+1:nb], w = v^T*A row by row
+        const lgint c0 = j + 1;
+        if (c0 == nb)
+            continue;
+        memcpy(w, a + j * lda + c0, (nb - c0) * sizeof(*w));
+        for (lgint i = j + 1; i < m; i++)
+        {
+            const fdouble v = a[i * lda + j];
+            const fdouble *ri = a + i * lda;
+            for (lgint c = c0; c < nb; c++)
+            {
+                w[c - c0] += v * ri[c];
+            }
+        }
+        for (lgint c = c0; c < nb; c++)
+        {
+            w[c - c0] *= tau[j];
+            a[j * lda + c] -= w[c - c0];
+        }
+        for (lgint i = j + 1; i < m; i++)
+        {
+            const fdouble v = a[i * lda + j];
+            fdouble *ri = a + i * lda;
+            for (lgint c = c0; c < nb; c++)
+            {
+                ri[c] -= v * w[c - c0];
+            }
+        }
+    }
+}
+
+// explicit V(m, nb) of the reflectors stored below the diagonal of the panel A,
+// and the upper triangular T(nb, nb) with H_1*...*H_nb = I - V*T*V^T
+static void qr_block(const lgint m, const lgint nb, const fdouble *a, const lgint lda, const fdouble *tau,
+                     fdouble *v, fdouble *t)
+{
+    for (lgint i = 0; i < m; i++)
+    {
+        for (lgint j = 0; j < nb; j++)
+        {
+            v[i * nb + j] = (i > j) ? a[i * lda + j] : (i == j) ? 1. : 0.;
+        }
+    }
+
+    memset(t, 0, nb * nb * sizeof(*t));
+    for (lgint i = 0; i < nb; i++)
+    {
+        // T[0:i, i] <= -tau_i*T[0:i, 0:i]*V[:, 0:i]^T*v_i, z kept in the column i of T
+        for (lgint r = i; r < m; r++)
+        {
+            const fdouble vi = v[r * nb + i];
+            for (lgint p = 0; p < i; p++)
+            {
+                t[p * nb + i] += v[r * nb + p] * vi;
+            }
+        }
+        for (lgint p = 0; p < i; p++)
+        {
+            fdouble s = 0.;
+            for (lgint q = p; q < i; q++)
+            {
+                s += t[p * nb + q] * t[q * nb + i];
+            }
+            t[p * nb + i] = s;
+        }
+        for (lgint p = 0; p < i; p++)
+        {
+            t[p * nb + i] *= -tau[i];
+        }
+        t[i * nb + i] = tau[i];
+    }
+}
+
+// B(m, k) <= (I - V*op(T)*V^T)*B with op(T) = T^T when `trans` is set, the
+// workspace `w` holds 2*nb*k values
+static void qr_block_apply(const bool trans, const lgint m, const lgint nb, const lgint k,
+                           const fdouble *v, const fdouble *t, fdouble *b, const lgint ldb, fdouble *w)
+{
+    fdouble *w1 = w, *w2 = w + nb * k;
+    cml_gemm(true, false, nb, k, m, 1., v, nb, b, ldb, 0., w1, k);
+    cml_gemm(trans, false, nb, k, nb, 1., t, nb, w1, k, 0., w2, k);
+    cml_gemm(false, false, m, k, nb, -1., v, nb, w2, k, 1., b, ldb);
+}
+
+bool cml_qr(const lgint m, const lgint n, fdouble *a, const lgint lda, fdouble *tau)
+{
+    const lgint nb = (n < QR_BLOCK) ? n : QR_BLOCK;
+    fdouble *v = (fdouble *)malloc((m * nb + nb * nb + 2 * nb * n + 1) * sizeof(*v));
+    if (v == NULL)
+        return false;
+    fdouble *t = v + m * nb, *w = t + nb * nb;
+
+    for (lgint j0 = 0; j0 < n; j0 += QR_BLOCK)
+    {
+        const lgint jb = (n - j0 < QR_BLOCK) ? n - j0 : QR_BLOCK;
+        fdouble *panel = a + j0 * lda + j0;
+        qr_panel(m - j0, jb, panel, lda, tau + j0, w);
+
+        // trailing columns <= Q_block^T*A
+        const lgint rest = n - j0 - jb;
+        if (rest == 0)
+            break;
+        qr_block(m - j0, jb, panel, lda, tau + j0, v, t);
+        qr_block_apply(true, m - j0, jb, rest, v, t, panel + jb, lda, w);
+    }
+    free(v);
+    return true;
+}
+
+bool cml_qr_apply(const bool trans, const lgint m, const lgint n, const lgint k,
+                  const fdouble *a, const lgint lda, const fdouble *tau,
+                  fdouble *b, const lgint ldb)
+{
+    if (n == 0 || k == 0)
+        return true;
+    const lgint nb = (n < QR_BLOCK) ? n : QR_BLOCK;
+    fdouble *v = (fdouble *)malloc((m * nb + nb * nb + 2 * nb * k) * sizeof(*v));
+    if (v == NULL)
+        return false;
+    fdouble *t = v + m * nb, *w = t + nb * nb;
+
+    // Q^T = Q_last^T*...*Q_1^T applies the first block first, Q the last block first
+    const lgint blocks = (n + QR_BLOCK - 1) / QR_BLOCK;
+    for (lgint s = 0; s < blocks; s++)
+    {
+        const lgint j0 = (trans ? s : blocks - 1 - s) * QR_BLOCK;
+        const lgint jb = (n - j0 < QR_BLOCK) ? n - j0 : QR_BLOCK;
+        qr_block(m - j0, jb, a + j0 * lda + j0, lda, tau + j0, v, t);
+        qr_block_apply(trans, m - j0, jb, k, v, t, b + j0 * ldb, ldb, w);
+    }
+    free(v);
+    return true;
+}
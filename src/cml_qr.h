@@ -0,0 +1,20 @@
+#ifndef cml_qr_h
+#define cml_qr_h
+
+#include "cml_matrix.h"
+
+#include <stdbool.h>
+
+// A(m, n) <= Q*R in place for m >= n by Householder reflections: R on and
+// above the diagonal, the reflectors H_j = I - tau_j*v_j*v_j^T below it (the
+// leading one of v_j is implied) and their scalings in `tau` (n). Returns
+// false when the workspace cannot be allocated.
+bool cml_qr(const lgint m, const lgint n, fdouble *a, const lgint lda, fdouble *tau);
+
+// B(m, k) <= Q^T*B when `trans` is set and Q*B otherwise, Q = H_1*...*H_n
+// being held in A and `tau` as left by cml_qr
+bool cml_qr_apply(const bool trans, const lgint m, const lgint n, const lgint k,
+                  const fdouble *a, const lgint lda, const fdouble *tau,
+                  fdouble *b, const lgint ldb);
+
+#endif
@@ -0,0 +1,117 @@
+#include "cml_matrix_impl.h"
+#include "cml_pool.h"
+#include "cml_simd.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// number of elements below which a reduction runs on a single thread
+#define REDUCE_GRAIN 16384
+
+// number of columns reduced by one task
+#define REDUCE_COLUMNS 64
+
+// reduction of A into the vector `out`
+struct reduce
+{
+    cml_reduction op;
+    cml_matrix *a;
+    cml_matrix *out;
+
+    /* Accumulator row of the type of A and per-column work space, for the column reductions */
+    void *acc;
+    void *aux;
+};
+
+// element k of the vector `out`, a row or a column
+static inline void reduce_store(cml_matrix *const out, const lgint k, const fdouble value)
+{
+    if (out->n == 1)
+        matrix_store(out, k, 0, value);
+    else
+        matrix_store(out, 0, k, value);
+}
+
+#define REDUCE_T fdouble
+#define REDUCE_FN(name) name##_f64
+#define REDUCE_VEC(op) cml_vec_##op
+#include "cml_reduce_kernels.inc"
+
+#define REDUCE_T float
+#define REDUCE_FN(name) name##_f32
+#define REDUCE_VEC(op) cml_vec_##op##_f32
+#include "cml_reduce_kernels.inc"
+
+// whether A reduces into `out` holding `count` elements, reporting the error on behalf of `caller`
+static bool reduce_check(cml_matrix *const a, cml_matrix *const out, const lgint count, const char *caller)
+{
+    if (a == NULL || out == NULL)
+    {
+        fprintf(stderr, "error (%s): the matrix A or the output is null.\n", caller);
+        return false;
+    }
+    if (a->m == 0 || a->n == 0)
+    {
+        fprintf(stderr, "error (%s): the matrix A is empty.\n", caller);
+        return false;
+    }
+    if ((out->m != 1 && out->n != 1) || out->m * out->n != count || out->dtype != a->dtype)
+    {
+        fprintf(stderr, "error (%s): the output should be a vector of %ld elements of the dtype of A.\n", caller, count);
+        return false;
+    }
+    return true;
+}
+
+cml_matrix *cml_matrix_reduce_columns(const cml_reduction op, cml_matrix *const a, cml_matrix *out)
+{
+    if (!reduce_check(a, out, (a != NULL) ? a->n : 0, "cml_matrix_reduce_columns") || matrix_unshare(out, false) == NULL)
+        return NULL;
+
+    // the accumulator is the output itself when its elements follow each other
+    const bool direct = out->m == 1 || matrix_ld(out) == 1;
+    struct reduce r = {op, a, out, NULL, NULL};
+    r.acc = direct ? out->data : malloc(a->n * matrix_elsize(a));
+    if (op == REDUCE_ARGMAX || op == REDUCE_LOGSUMEXP)
+        r.aux = malloc(a->n * sizeof(fdouble));
+    if (r.acc == NULL || ((op == REDUCE_ARGMAX || op == REDUCE_LOGSUMEXP) && r.aux == NULL))
+    {
+        fprintf(stderr, "error (cml_matrix_reduce_columns): the allocation memory has failed.\n");
+        if (!direct)
+            free(r.acc);
+        free(r.aux);
+        return NULL;
+    }
+
+    const lgint grain = (a->m * a->n < REDUCE_GRAIN) ? a->n : REDUCE_COLUMNS;
+    if (a->dtype == FLOAT32)
+        cml_pool_run(a->n, grain, &reduce_columns_f32, &r);
+    else
+        cml_pool_run(a->n, grain, &reduce_columns_f64, &r);
+
+    if (!direct)
+    {
+        for (lgint k = 0; k < a->n; k++)
+        {
+            reduce_store(out, k, (a->dtype == FLOAT32) ? ((float *)r.acc)[k] : ((fdouble *)r.acc)[k]);
+        }
+        free(r.acc);
+    }
+    free(r.aux);
+    return out;
+}
+
+cml_matrix *cml_matrix_reduce_rows(const cml_reduction op, cml_matrix *const a, cml_matrix *out)
+{
+    if (!reduce_check(a, out, (a != NULL) ? a->m : 0, "cml_matrix_reduce_rows") || matrix_unshare(out, false) == NULL)
+        return NULL;
+
+    struct reduce r = {op, a, out, NULL, NULL};
+    if (a->dtype == FLOAT32)
+        cml_pool_run(a->m, 1 + REDUCE_GRAIN / a->n, &reduce_rows_f32, &r);
+    else
+        cml_pool_run(a->m, 1 + REDUCE_GRAIN / a->n, &reduce_rows_f64, &r);
+    return out;
+}
@@ -0,0 +1,423 @@
+#include "cml_scaler.h"
+#include "cml_matrix_impl.h"
+#include "cml_pool.h"
+#include "cml_simd.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// number of elements below which the statistics or a transformation run on a single thread
+#define SCALER_GRAIN 16384
+
+// first line of a saved scaler, followed by the version of the format
+#define SCALER_MAGIC "cml_scaler"
+#define SCALER_VERSION 1
+
+// statistics of n columns over `count` rows, merged with Chan's update
+struct scaler_stats
+{
+    lgint count;
+    fdouble *mean;
+    fdouble *m2;
+    fdouble *min;
+    fdouble *max;
+};
+
+struct scaler
+{
+    /* Public interface */
+    cml_scaler pub;
+
+    /* Statistics of the rows seen by fit and partial_fit */
+    struct scaler_stats stats;
+
+    /* x' = (x - shift) * scale and x = x' * unscale + shift, for each type of data */
+    fdouble *shift, *scale, *unscale;
+    float *shift_f32, *scale_f32, *unscale_f32;
+};
+
+static void scaler_fit(cml_scaler *const scaler, cml_matrix *const x);
+static void scaler_free(cml_scaler **scaler);
+static cml_matrix *scaler_inverse_transform(cml_scaler *const scaler, cml_matrix *x);
+static void scaler_partial_fit(cml_scaler *const scaler, cml_matrix *const x);
+static bool scaler_save(cml_scaler *const scaler, const char *file_path);
+static cml_matrix *scaler_transform(cml_scaler *const scaler, cml_matrix *x);
+
+// empty statistics of n columns, the four arrays share one block
+static bool stats_init(struct scaler_stats *stats, const lgint n)
+{
+    stats->count = 0;
+    stats->mean = (fdouble *)malloc((4 * n + 1) * sizeof(fdouble));
+    if (stats->mean == NULL)
+        return false;
+    stats->m2 = stats->mean + n;
+    stats->min = stats->m2 + n;
+    stats->max = stats->min + n;
+    for (lgint j = 0; j < n; j++)
+    {
+        stats->mean[j] = 0.;
+        stats->m2[j] = 0.;
+        stats->min[j] = INFINITY;
+        stats->max[j] = -INFINITY;
+    }
+    return true;
+}
+
+// Welford's update with the row x of n values
+static void stats_add(struct scaler_stats *stats, const fdouble *x, const lgint n)
+{
+    stats->count++;
+    const fdouble inv = 1. / stats->count;
+    for (lgint j = 0; j < n; j++)
+    {
+        const fdouble delta = x[j] - stats->mean[j];
+        stats->mean[j] += delta * inv;
+        stats->m2[j] += delta * (x[j] - stats->mean[j]);
+        stats->min[j] = (x[j] < stats->min[j]) ? x[j] : stats->min[j];
+        stats->max[j] = (x[j] > stats->max[j]) ? x[j] : stats->max[j];
+    }
+}
+
+// dst <= statistics of the rows of dst and of src together
+static void stats_merge(struct scaler_stats *dst, const struct scaler_stats *src, const lgint n)
+{
+    if (src->count == 0)
+        return;
+    const fdouble na = dst->count, nb = src->count, count = na + nb;
+    for (lgint j = 0; j < n; j++)
+    {
+        const fdouble delta = src->mean[j] - dst->mean[j];
+        dst->mean[j] += delta * nb / count;
+        dst->m2[j] += src->m2[j] + delta * delta * na * nb / count;
+        dst->min[j] = (src->min[j] < dst->min[j]) ? src->min[j] : dst->min[j];
+        dst->max[j] = (src->max[j] > dst->max[j]) ? src->max[j] : dst->max[j];
+    }
+    dst->count += src->count;
+}
+
+// parameters of the transformation for the columns of the fitted statistics
+static void scaler_update(struct scaler *scaler)
+{
+    const struct scaler_stats *stats = &scaler->stats;
+    for (lgint j = 0; j < scaler->pub.n; j++)
+    {
+        fdouble shift = stats->min[j], range = stats->max[j] - stats->min[j];
+        if (scaler->pub.scaling == STANDARD_SCALING)
+        {
+            shift = stats->mean[j];
+            range = (stats->count > 0) ? sqrt(stats->m2[j] / stats->count) : 0.;
+        }
+        // a constant column is only shifted
+        const fdouble scale = (range > 0.) ? 1. / range : 1.;
+        scaler->shift[j] = shift;
+        scaler->scale[j] = scale;
+        scaler->unscale[j] = 1. / scale;
+        scaler->shift_f32[j] = (float)shift;
+        scaler->scale_f32[j] = (float)scale;
+        scaler->unscale_f32[j] = (float)(1. / scale);
+    }
+}
+
+// statistics and parameters of a scaler of n columns
+static bool scaler_alloc(struct scaler *scaler, const lgint n)
+{
+    if (!stats_init(&scaler->stats, n))
+        return false;
+    scaler->shift = (fdouble *)malloc((3 * n + 1) * sizeof(fdouble));
+    scaler->shift_f32 = (float *)malloc((3 * n + 1) * sizeof(float));
+    if (scaler->shift == NULL || scaler->shift_f32 == NULL)
+        return false;
+    scaler->scale = scaler->shift + n;
+    scaler->unscale = scaler->scale + n;
+    scaler->scale_f32 = scaler->shift_f32 + n;
+    scaler->unscale_f32 = scaler->scale_f32 + n;
+    *(lgint *)(&scaler->pub.n) = n;
+    return true;
+}
+
+// back to the state of an unfitted scaler
+static void scaler_release(struct scaler *scaler)
+{
+    free(scaler->stats.mean);
+    free(scaler->shift);
+    free(scaler->shift_f32);
+    scaler->stats.count = 0;
+    scaler->stats.mean = NULL;
+    scaler->shift = NULL;
+    scaler->shift_f32 = NULL;
+    *(lgint *)(&scaler->pub.n) = 0;
+}
+
+cml_scaler *cml_scaler_create(const cml_scaling scaling)
+{
+    struct scaler *scaler = (struct scaler *)malloc(sizeof(*scaler));
+    if (scaler == NULL)
+    {
+        fprintf(stderr, "error (cml_scaler_create): the allocation memory has failed.\n");
+        return NULL;
+    }
+    *(cml_scaling *)(&scaler->pub.scaling) = scaling;
+    *(lgint *)(&scaler->pub.n) = 0;
+
+    scaler->pub.fit = &scaler_fit;
+    scaler->pub.free = &scaler_free;
+    scaler->pub.inverse_transform = &scaler_inverse_transform;
+    scaler->pub.partial_fit = &scaler_partial_fit;
+    scaler->pub.save = &scaler_save;
+    scaler->pub.transform = &scaler_transform;
+
+    scaler->stats.count = 0;
+    scaler->stats.mean = NULL;
+    scaler->shift = NULL;
+    scaler->shift_f32 = NULL;
+
+    return &scaler->pub;
+}
+
+cml_scaler *cml_scaler_load(const char *file_path)
+{
+    FILE *stream = fopen(file_path, "r");
+    if (stream == NULL)
+    {
+        fprintf(stderr, "error (cml_scaler_load): cannot open the file %s.\n", file_path);
+        return NULL;
+    }
+    char magic[16] = "";
+    int version = 0, scaling = 0;
+    lgint n = 0, count = 0;
+    if (fscanf(stream, "%15s %d %d %lu %lu", magic, &version, &scaling, &n, &count) != 5 ||
+        strcmp(magic, SCALER_MAGIC) != 0 || version != SCALER_VERSION || n == 0)
+    {
+        fprintf(stderr, "error (cml_scaler_load): the file %s is not a saved scaler.\n", file_path);
+        fclose(stream);
+        return NULL;
+    }
+
+    cml_scaler *self = cml_scaler_create((cml_scaling)scaling);
+    struct scaler *scaler = (struct scaler *)self;
+    if (self == NULL || !scaler_alloc(scaler, n))
+    {
+        fprintf(stderr, "error (cml_scaler_load): the allocation memory has failed.\n");
+        if (self != NULL)
+            scaler_free(&self);
+        fclose(stream);
+        return NULL;
+    }
+    scaler->stats.count = count;
+    for (lgint j = 0; j < n; j++)
+    {
+        if (fscanf(stream, "%lf %lf %lf %lf", &scaler->stats.mean[j], &scaler->stats.m2[j], &scaler->stats.min[j], &scaler->stats.max[j]) != 4)
+        {
+            fprintf(stderr, "error (cml_scaler_load): the file %s is truncated.\n", file_path);
+            scaler_free(&self);
+            fclose(stream);
+            return NULL;
+        }
+    }
+    fclose(stream);
+    scaler_update(scaler);
+    return self;
+}
+
+void scaler_fit(cml_scaler *const self, cml_matrix *const x)
+{
+    if (self == NULL)
+        return;
+    // the statistics start over, possibly for another number of columns
+    scaler_release((struct scaler *)self);
+    scaler_partial_fit(self, x);
+}
+
+void scaler_free(cml_scaler **self)
+{
+    if (*self == NULL)
+        return;
+    struct scaler *scaler = (struct scaler *)(*self);
+    scaler_release(scaler);
+    free(scaler);
+    *self = NULL;
+}
+
+// X <= (X - shift)*scale, or X*unscale + shift when `inverse` is set, on the rows [begin, end)
+struct scaler_apply
+{
+    struct scaler *scaler;
+    cml_matrix *x;
+    bool inverse;
+};
+
+static void scaler_apply_task(void *ctx, const lgint begin, const lgint end)
+{
+    const struct scaler_apply *op = (const struct scaler_apply *)ctx;
+    const struct scaler *scaler = op->scaler;
+    const lgint n = op->x->n;
+    for (lgint i = begin; i < end; i++)
+    {
+        if (op->x->dtype == FLOAT32)
+        {
+            float *row = (float *)matrix_ptr(op->x, i, 0);
+            if (op->inverse)
+            {
+                cml_vec_mul_f32(n, row, scaler->unscale_f32, row);
+                cml_vec_add_f32(n, row, scaler->shift_f32, row);
+            }
+            else
+            {
+                cml_vec_sub_f32(n, row, scaler->shift_f32, row);
+                cml_vec_mul_f32(n, row, scaler->scale_f32, row);
+            }
+        }
+        else
+        {
+            fdouble *row = (fdouble *)matrix_ptr(op->x, i, 0);
+            if (op->inverse)
+            {
+                cml_vec_mul(n, row, scaler->unscale, row);
+                cml_vec_add(n, row, scaler->shift, row);
+            }
+            else
+            {
+                cml_vec_sub(n, row, scaler->shift, row);
+                cml_vec_mul(n, row, scaler->scale, row);
+            }
+        }
+    }
+}
+
+static cml_matrix *scaler_apply(cml_scaler *const self, cml_matrix *x, const bool inverse, const char *caller)
+{
+    if (self == NULL)
+        return NULL;
+    if (x == NULL)
+    {
+        fprintf(stderr, "error (%s): the matrix X is null.\n", caller);
+        return NULL;
+    }
+    if (self->n == 0)
+    {
+        fprintf(stderr, "error (%s): the scaler should be fitted first.\n", caller);
+        return NULL;
+    }
+    if (x->n != self->n)
+    {
+        fprintf(stderr, "error (%s): the matrix X should have %ld columns.\n", caller, self->n);
+        return NULL;
+    }
+    if (matrix_unshare(x, true) == NULL)
+        return NULL;
+    struct scaler_apply op = {(struct scaler *)self, x, inverse};
+    cml_pool_run(x->m, 1 + SCALER_GRAIN / x->n, &scaler_apply_task, &op);
+    return x;
+}
+
+cml_matrix *scaler_inverse_transform(cml_scaler *const self, cml_matrix *x)
+{
+    return scaler_apply(self, x, true, "scaler_inverse_transform");
+}
+
+// rows of X whose statistics are merged into those of the scaler
+struct scaler_pass
+{
+    struct scaler *scaler;
+    cml_matrix *x;
+    pthread_mutex_t lock;
+    bool failed;
+};
+
+// statistics of the rows [begin, end) in a private accumulator, merged at the end
+static void scaler_pass_task(void *ctx, const lgint begin, const lgint end)
+{
+    struct scaler_pass *pass = (struct scaler_pass *)ctx;
+    const lgint n = pass->x->n;
+    struct scaler_stats local;
+    fdouble *row = (fdouble *)malloc(n * sizeof(*row));
+    if (row == NULL || !stats_init(&local, n))
+    {
+        free(row);
+        pthread_mutex_lock(&pass->lock);
+        pass->failed = true;
+        pthread_mutex_unlock(&pass->lock);
+        return;
+    }
+    for (lgint i = begin; i < end; i++)
+    {
+        const fdouble *x = (const fdouble *)matrix_ptr(pass->x, i, 0);
+        if (pass->x->dtype == FLOAT32)
+        {
+            const float *xf = (const float *)matrix_ptr(pass->x, i, 0);
+            for (lgint j = 0; j < n; j++)
+                row[j] = xf[j];
+            x = row;
+        }
+        stats_add(&local, x, n);
+    }
+
+    pthread_mutex_lock(&pass->lock);
+    stats_merge(&pass->scaler->stats, &local, n);
+    pthread_mutex_unlock(&pass->lock);
+    free(local.mean);
+    free(row);
+}
+
+void scaler_partial_fit(cml_scaler *const self, cml_matrix *const x)
+{
+    if (self == NULL)
+        return;
+    struct scaler *scaler = (struct scaler *)self;
+    if (x == NULL || x->n == 0)
+    {
+        fprintf(stderr, "error (scaler_partial_fit): the matrix X is null or empty.\n");
+        return;
+    }
+    if (self->n == 0 && !scaler_alloc(scaler, x->n))
+    {
+        fprintf(stderr, "error (scaler_partial_fit): the allocation memory has failed.\n");
+        scaler_release(scaler);
+        return;
+    }
+    if (x->n != self->n)
+    {
+        fprintf(stderr, "error (scaler_partial_fit): the matrix X should have %ld columns.\n", self->n);
+        return;
+    }
+
+    struct scaler_pass pass = {scaler, x, PTHREAD_MUTEX_INITIALIZER, false};
+    cml_pool_run(x->m, 1 + SCALER_GRAIN / x->n, &scaler_pass_task, &pass);
+    pthread_mutex_destroy(&pass.lock);
+    if (pass.failed)
+        fprintf(stderr, "error (scaler_partial_fit): the allocation memory has failed, some rows are missing from the statistics.\n");
+    scaler_update(scaler);
+}
+
+bool scaler_save(cml_scaler *const self, const char *file_path)
+{
+    if (self == NULL)
+        return false;
+    if (self->n == 0)
+    {
+        fprintf(stderr, "error (scaler_save): the scaler should be fitted first.\n");
+        return false;
+    }
+    FILE *stream = fopen(file_path, "w");
+    if (stream == NULL)
+    {
+        fprintf(stderr, "error (scaler_save): cannot open the file %s.\n", file_path);
+        return false;
+    }
+    // %.17g writes back the exact doubles
+    const struct scaler_stats *stats = &((struct scaler *)self)->stats;
+    fprintf(stream, "%s %d %d %lu %lu\n", SCALER_MAGIC, SCALER_VERSION, (int)self->scaling, self->n, stats->count);
+    for (lgint j = 0; j < self->n; j++)
+    {
+        fprintf(stream, "%.17g %.17g %.17g %.17g\n", stats->mean[j], stats->m2[j], stats->min[j], stats->max[j]);
+    }
+    return fclose(stream) == 0;
+}
+
+cml_matrix *scaler_transform(cml_scaler *const self, cml_matrix *x)
+{
+    return scaler_apply(self, x, false, "scaler_transform");
+}
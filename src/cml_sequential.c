@@ -1,26 +1,32 @@
 #include "cml_sequential.h"
+#include "cml_matrix_impl.h"
+#include "cml_simd.h"
 
 #include <float.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #define CML_EPSILON 1E-06
 
+// size in bytes of the first chunk of the arena of a model
+#define CML_SEQUENTIAL_ARENA (1 << 20)
+
 static fdouble matrix_sum(cml_matrix *const a)
 {
-    if (a == NULL)
+    if (a == NULL || a->m == 0 || a->n == 0)
         return 0;
 
-    fdouble s = 0;
-    for (lgint i = 0; i < a->m; i++)
-    {
-        for (lgint j = 0; j < a->n; j++)
-        {
-            s += a->get(a, i, j);
-        }
-    }
+    // the column sums, then their sum
+    cml_matrix *cols = cml_matrix_alloc_dtype(1, a->n, a->dtype);
+    cml_matrix *total = cml_matrix_alloc_dtype(1, 1, a->dtype);
+    cml_matrix_reduce_columns(REDUCE_SUM, a, cols);
+    cml_matrix_reduce_rows(REDUCE_SUM, cols, total);
+    const fdouble s = matrix_load(total, 0, 0);
+    cols->vt->free(&cols);
+    total->vt->free(&total);
     return s;
 }
 
@@ -38,14 +44,14 @@ void cml_class_metrics(cml_matrix **prec, cml_matrix **accur, cml_matrix **f1_sc
 
     for (lgint i = 0; i < conf->m; i++)
     {
-        const fdouble tp = conf->get(conf, i, i);
+        const fdouble tp = matrix_load(conf, i, i);
         for (lgint j = 0; j < conf->n; j++)
         {
             fdouble fn = 0, fp = 0;
             for (lgint k = 0; k < conf->n; k++)
             {
-                fn += conf->get(conf, i, k);
-                fp += conf->get(conf, k, i);
+                fn += matrix_load(conf, i, k);
+                fp += matrix_load(conf, k, i);
             }
             fn -= tp;
             fp -= tp;
@@ -66,12 +72,12 @@ void cml_class_metrics(cml_matrix **prec, cml_matrix **accur, cml_matrix **f1_sc
             if (p + rec != 0)
                 score = 2 * p * rec / (p + rec);
 
-            (*prec)->set(prec, i, j, p);
-            (*accur)->set(accur, i, j, a);
-            (*f1_score)->set(f1_score, i, j, score);
+            matrix_store(*prec, i, j, p);
+            matrix_store(*accur, i, j, a);
+            matrix_store(*f1_score, i, j, score);
         }
     }
-    conf->free(&conf);
+    conf->vt->free(&conf);
 }
 
 static fdouble cml_huber_loss(const fdouble yhat_i, const fdouble y_i, const fdouble threshold)
@@ -96,7 +102,7 @@ static fdouble cml_median_abs_error(cml_matrix *const yhat, cml_matrix *const y)
     {
         for (lgint j = 0; j < yhat->n; j++)
         {
-            med[i * yhat->n + j] = fabs(yhat->get(yhat, i, j) - y->get(y, i, j));
+            med[i * yhat->n + j] = fabs(matrix_load(yhat, i, j) - matrix_load(y, i, j));
         }
     }
     // sorting the array using qsort
@@ -125,8 +131,8 @@ void cml_reg_metrics(fdouble *mae, fdouble *mse, fdouble *rmse,
     {
         for (lgint j = 0; j < yhat->n; j++)
         {
-            const fdouble yhat_ij = yhat->get(yhat, i, j);
-            const fdouble y_ij = y->get(y, i, j);
+            const fdouble yhat_ij = matrix_load(yhat, i, j);
+            const fdouble y_ij = matrix_load(y, i, j);
             const fdouble delta = yhat_ij - y_ij;
             y_mean += y_ij;
             y_mean2 += y_ij * y_ij;
@@ -146,8 +152,8 @@ void cml_reg_metrics(fdouble *mae, fdouble *mse, fdouble *rmse,
     {
         for (lgint j = 0; j < yhat->n; j++)
         {
-            const fdouble yhat_ij = yhat->get(yhat, i, j);
-            const fdouble y_ij = y->get(y, i, j);
+            const fdouble yhat_ij = matrix_load(yhat, i, j);
+            const fdouble y_ij = matrix_load(y, i, j);
             const fdouble delta = yhat_ij - y_ij;
             *mae += fabs(delta);
             *mse += delta * delta;
@@ -177,15 +183,30 @@ struct sequential
 
     /* Placeholder for data */
     bool is_compiled;
+
+    /* Temporaries of an epoch, and buffers kept for the whole training */
+    cml_allocator *arena;
+    cml_allocator *pool;
+
+    /* Temporaries of a prediction, reused by the thread holding the lock (created on first use) */
+    cml_allocator *predict_arena;
+    pthread_mutex_t predict_lock;
 };
 
 static void sequential_compile(cml_sequential *const model, cml_prng *const prng);
 static void sequential_fit(cml_sequential *const model, cml_matrix *const x, cml_matrix *const y, fdouble (*learning_rate)(fdouble alpha), const fdouble alpha, const lgint epochs);
+static void sequential_fit_sparse(cml_sequential *const model, cml_sparse *const x, cml_matrix *const y, fdouble (*learning_rate)(fdouble alpha), const fdouble alpha, const lgint epochs);
 static void sequential_free(cml_sequential **model);
 static cml_matrix *sequential_predict(cml_sequential *const model, cml_matrix *const x);
+static cml_matrix *sequential_predict_sparse(cml_sequential *const model, cml_sparse *const x);
 static void sequential_summary(cml_sequential *const model);
 
 cml_sequential *cml_sequential_create(cml_layer *layers[], const lgint n_layers, const lgint n_inputs, const cml_loss loss)
+{
+    return cml_sequential_create_dtype(layers, n_layers, n_inputs, loss, FLOAT64);
+}
+
+cml_sequential *cml_sequential_create_dtype(cml_layer *layers[], const lgint n_layers, const lgint n_inputs, const cml_loss loss, const cml_dtype dtype)
 {
     struct sequential *model = NULL;
     const size_t size = sizeof(*model);
@@ -194,14 +215,21 @@ cml_sequential *cml_sequential_create(cml_layer *layers[], const lgint n_layers,
     *(lgint *)(&model->pub.n_layers) = n_layers;
     *(lgint *)(&model->pub.n_inputs) = n_inputs;
     *(cml_loss *)(&model->pub.loss) = loss;
+    *(cml_dtype *)(&model->pub.dtype) = dtype;
 
     model->pub.compile = &sequential_compile;
     model->pub.fit = &sequential_fit;
+    model->pub.fit_sparse = &sequential_fit_sparse;
     model->pub.free = &sequential_free;
     model->pub.predict = &sequential_predict;
+    model->pub.predict_sparse = &sequential_predict_sparse;
     model->pub.summary = &sequential_summary;
 
     model->is_compiled = false;
+    model->arena = cml_arena_create(CML_SEQUENTIAL_ARENA);
+    model->pool = cml_size_pool_create();
+    model->predict_arena = NULL;
+    pthread_mutex_init(&model->predict_lock, NULL);
 
     return &model->pub;
 }
@@ -217,80 +245,125 @@ void sequential_compile(cml_sequential *const model, cml_prng *const prng)
             layer->compile(layer, model->n_inputs, prng);
         else
             layer->compile(layer, model->layers[i - 1]->weight(model->layers[i - 1])->n, prng);
+        layer->cast(layer, model->dtype);
     }
     struct sequential *sequential = (struct sequential *)model;
     sequential->is_compiled = true;
 }
 
-static void sequential_forward(cml_sequential *const model, cml_matrix *const x, cml_matrix **inputs)
+// temporary (m, n) of the type of the model, valid until the arena is reset
+static cml_matrix *sequential_temp(cml_sequential *const model, const lgint m, const lgint n)
+{
+    struct sequential *sequential = (struct sequential *)model;
+    return cml_matrix_alloc_with(sequential->arena, m, n, model->dtype);
+}
+
+// input X (m, n_inputs) of the model, held by one of `dense` and `sparse`
+struct sequential_batch
+{
+    cml_matrix *dense;
+    cml_sparse *sparse;
+    lgint m;
+};
+
+// output of the first layer for X into `out`, and its derivative into `grad` unless it is NULL
+static cml_matrix *sequential_first(cml_layer *const layer, const struct sequential_batch *x, cml_matrix *out, cml_matrix *grad)
+{
+    if (x->sparse != NULL)
+    {
+        if (grad != NULL)
+            return layer->forward_sparse_into(layer, x->sparse, out, grad);
+        return layer->eval_sparse_into(layer, x->sparse, out);
+    }
+    if (grad != NULL)
+        return layer->forward_into(layer, x->dense, out, grad);
+    return layer->eval_into(layer, x->dense, out);
+}
+
+// the derivatives of the activations of the hidden layers are kept in `grads`
+// as their outputs are computed, so that the backward pass does not run the
+// products again (the output layer has none)
+static void sequential_forward(cml_sequential *const model, const struct sequential_batch *x, cml_matrix **inputs, cml_matrix **grads)
 {
     for (lgint n = 0; n < model->n_layers; n++)
     {
         cml_layer *layer = model->layers[n];
+        cml_matrix *out = sequential_temp(model, x->m, layer->units);
+        grads[n] = (n < model->n_layers - 1) ? sequential_temp(model, x->m, layer->units) : NULL;
         if (n == 0)
-            inputs[n] = layer->eval(layer, x);
+            inputs[n] = sequential_first(layer, x, out, grads[n]);
+        else if (grads[n] != NULL)
+            inputs[n] = layer->forward_into(layer, inputs[n - 1], out, grads[n]);
         else
-            inputs[n] = layer->eval(layer, inputs[n - 1]);
+            inputs[n] = layer->eval_into(layer, inputs[n - 1], out);
     }
 }
 
-static cml_matrix *gradient_bias(cml_matrix *const err, const lgint m)
+// output of the model for X, the intermediate outputs are drawn from the arena
+// `temps` and the last one from `allocator`, or from the system when it is NULL
+static cml_matrix *sequential_eval(cml_sequential *const model, const struct sequential_batch *x, cml_allocator *const temps, cml_allocator *const allocator)
 {
-    cml_matrix *gradB = cml_matrix_alloc(err->n, 1);
-    for (lgint i = 0; i < gradB->m; i++)
+    cml_matrix *a = NULL;
+    for (lgint i = 0; i < model->n_layers; i++)
     {
-        fdouble s = 0.;
-        for (lgint j = 0; j < err->m; j++)
+        cml_layer *layer = model->layers[i];
+        cml_matrix *z = NULL;
+        if (i < model->n_layers - 1)
+            z = cml_matrix_alloc_with(temps, x->m, layer->units, model->dtype);
+        else if (allocator != NULL)
+            z = cml_matrix_alloc_with(allocator, x->m, layer->units, model->dtype);
+        else
+            z = cml_matrix_alloc_dtype(x->m, layer->units, model->dtype);
+
+        cml_matrix *out = (i == 0) ? sequential_first(layer, x, z, NULL) : layer->eval_into(layer, a, z);
+        if (out == NULL)
         {
-            s += err->get(err, j, i);
+            if (z != NULL)
+                z->vt->free(&z);
+            if (a != NULL)
+                a->vt->free(&a);
+            return NULL;
         }
-        gradB->set(&gradB, i, 0, s / m);
+        if (a != NULL)
+            a->vt->free(&a);
+        a = z;
     }
-    return gradB;
+    return a;
 }
 
-static cml_matrix *gradient_weight(cml_matrix *const input, cml_matrix *const err, const lgint m)
+// gradB = the mean of the rows of err
+static void gradient_bias(cml_matrix *const err, cml_matrix *gradB)
 {
-    cml_matrix *input_transpose = NULL;
-    input->transpose(input, &input_transpose);
-    cml_matrix *gradW = cml_matrix_alloc(input_transpose->m, err->n);
-    for (lgint i = 0; i < gradW->m; i++)
-    {
-        for (lgint j = 0; j < gradW->n; j++)
-        {
-            fdouble s = 0.;
-            for (lgint k = 0; k < input_transpose->n; k++)
-            {
-                s += input_transpose->get(input_transpose, i, k) * err->get(err, k, j);
-            }
-            gradW->set(&gradW, i, j, s / m);
-        }
-    }
-    input_transpose->free(&input_transpose);
-    return gradW;
+    cml_matrix_reduce_columns(REDUCE_MEAN, err, gradB);
+}
+
+// gradW = input^T*err / m, the input is read in place
+static void gradient_weight(cml_matrix *const input, cml_matrix *const err, const lgint m, cml_matrix *gradW)
+{
+    cml_matrix_gemm(true, false, 1. / m, input, err, 0., gradW);
 }
 
 static void update_weight_bias(cml_matrix **weight, cml_matrix **bias, cml_matrix *const gradW, cml_matrix *const gradB, const fdouble alpha)
 {
-    for (lgint j = 0; j < (*weight)->n; j++)
+    // the weights may have been copied, e.g. to keep the best ones
+    if (matrix_unshare(*weight, true) == NULL || matrix_unshare(*bias, true) == NULL)
+        return;
+    if ((*weight)->dtype == FLOAT32)
     {
-        for (lgint i = 0; i < (*weight)->m; i++)
-        {
-            (*weight)->set(
-                weight,
-                i, j,
-                (*weight)->get(*weight, i, j) - alpha * gradW->get(gradW, i, j));
-        }
-        (*bias)->set(
-            bias,
-            j, 0,
-            (*bias)->get(*bias, j, 0) - alpha * gradB->get(gradB, j, 0));
+        cml_vec_axpy_f32((*weight)->m * (*weight)->n, -alpha, matrix_data_f32(gradW), matrix_data_f32(*weight));
+        cml_vec_axpy_f32((*bias)->m * (*bias)->n, -alpha, matrix_data_f32(gradB), matrix_data_f32(*bias));
+        return;
     }
+    cml_vec_axpy((*weight)->m * (*weight)->n, -alpha, matrix_data(gradW), matrix_data(*weight));
+    cml_vec_axpy((*bias)->m * (*bias)->n, -alpha, matrix_data(gradB), matrix_data(*bias));
 }
 
-static void sequential_backward(cml_sequential *const model, cml_matrix *const x, cml_matrix **inputs, cml_matrix *const y, const fdouble alpha)
+// `grads` holds the derivatives of the activations kept by the forward pass, which are freed here;
+// `grads_w` and `grads_b` hold one preallocated gradient per layer, reused across epochs
+static void sequential_backward(cml_sequential *const model, const struct sequential_batch *x, cml_matrix **inputs, cml_matrix **grads, cml_matrix *const y,
+                                const fdouble alpha, cml_matrix **grads_w, cml_matrix **grads_b)
 {
-    cml_matrix *err = cml_matrix_dif(inputs[model->n_layers - 1], y);
+    cml_matrix *err = cml_matrix_dif_into(inputs[model->n_layers - 1], y, sequential_temp(model, y->m, y->n));
     const lgint m = x->m;
 
     for (long n = model->n_layers - 2; n >= 0; n--)
@@ -301,122 +374,104 @@ static void sequential_backward(cml_sequential *const model, cml_matrix *const x
         cml_matrix *W = layer->weight(layer);
         cml_matrix *b = layer->bias(layer);
 
-        cml_matrix *gradW = gradient_weight(input, err, m);
-        cml_matrix *gradB = gradient_bias(err, m);
+        gradient_weight(input, err, m, grads_w[n + 1]);
+        gradient_bias(err, grads_b[n + 1]);
 
-        update_weight_bias(&W, &b, gradW, gradB, alpha);
+        update_weight_bias(&W, &b, grads_w[n + 1], grads_b[n + 1], alpha);
 
-        gradW->free(&gradW);
-        gradB->free(&gradB);
+        cml_matrix *prod = cml_matrix_gemm(false, true, 1., err, W, 0., sequential_temp(model, err->m, W->m));
+        err->vt->free(&err);
 
-        cml_matrix *WT = NULL;
-        W->transpose(W, &WT);
-        cml_matrix *prod = cml_matrix_prod(err, WT);
-        err->free(&err);
-        WT->free(&WT);
-        layer = model->layers[n];
-        cml_matrix *zp = NULL;
-        if (n > 0)
-            zp = layer->gradient(layer, inputs[n - 1]);
-        else
-            zp = layer->gradient(layer, x);
-
-        err = prod->hadamard(prod, zp);
-        zp->free(&zp);
-        prod->free(&prod);
+        // the back-propagated error overwrites the product in place
+        err = cml_matrix_hadamard_into(prod, grads[n], prod);
+        grads[n]->vt->free(&grads[n]);
     }
 
-    err->free(&err);
+    err->vt->free(&err);
 }
 
-static fdouble sequential_mse(cml_sequential *const model, cml_matrix *const x, cml_matrix *const y)
+static fdouble sequential_mse(cml_sequential *const model, const struct sequential_batch *x, cml_matrix *const y)
 {
     if (model == NULL)
         return DBL_MAX;
-    cml_matrix *yhat = model->predict(model, x);
+    struct sequential *sequential = (struct sequential *)model;
+    cml_matrix *yhat = sequential_eval(model, x, sequential->arena, sequential->arena);
     if (yhat == NULL)
         return DBL_MAX;
-    cml_matrix *dif = cml_matrix_dif(yhat, y);
-    yhat->free(&yhat);
-    cml_matrix *dif_t = NULL;
-    dif->transpose(dif, &dif_t);
-    cml_matrix *tmp = cml_matrix_prod(dif_t, dif);
-    dif->free(&dif);
-    dif_t->free(&dif_t);
-    fdouble mse = 0.;
-    for (lgint i = 0; i < tmp->m; i++)
-    {
-        for (lgint j = 0; j < tmp->n; j++)
-        {
-            mse += tmp->get(tmp, i, j);
-        }
-    }
-    mse /= (2 * y->m);
-    tmp->free(&tmp);
+    cml_matrix *dif = cml_matrix_dif_into(yhat, y, sequential_temp(model, y->m, y->n));
+    yhat->vt->free(&yhat);
+    cml_matrix *tmp = cml_matrix_gemm(true, false, 1., dif, dif, 0., sequential_temp(model, dif->n, dif->n));
+    dif->vt->free(&dif);
+    const fdouble mse = matrix_sum(tmp) / (2 * y->m);
+    tmp->vt->free(&tmp);
     return mse;
 }
 
-static fdouble sequential_softmax_entropy(cml_sequential *const model, cml_matrix *const x, cml_matrix *const y)
+static fdouble sequential_softmax_entropy(cml_sequential *const model, const struct sequential_batch *x, cml_matrix *const y)
 {
     if (model == NULL)
         return DBL_MAX;
-    cml_matrix *prob = model->predict(model, x);
+    struct sequential *sequential = (struct sequential *)model;
+    cml_matrix *prob = sequential_eval(model, x, sequential->arena, sequential->arena);
     if (prob == NULL)
         return DBL_MAX;
-    cml_matrix *lprob = cml_matrix_alloc(prob->m, prob->n);
+    cml_matrix *lprob = sequential_temp(model, prob->m, prob->n);
     for (lgint i = 0; i < lprob->m; i++)
     {
         for (lgint j = 0; j < lprob->n; j++)
         {
-            lprob->set(&lprob, i, j, log(prob->get(prob, i, j)));
+            matrix_store(lprob, i, j, log(matrix_load(prob, i, j)));
         }
     }
-    prob->free(&prob);
-    cml_matrix *ytranspose = NULL;
-    y->transpose(y, &ytranspose);
-    cml_matrix *prod = cml_matrix_prod(ytranspose, lprob);
-    ytranspose->free(&ytranspose);
-    lprob->free(&lprob);
-    const fdouble trace = prod->trace(prod);
-    prod->free(&prod);
+    prob->vt->free(&prob);
+    cml_matrix *prod = cml_matrix_gemm(true, false, 1., y, lprob, 0., sequential_temp(model, y->n, lprob->n));
+    lprob->vt->free(&lprob);
+    const fdouble trace = prod->vt->trace(prod);
+    prod->vt->free(&prod);
     return -trace / x->m;
 }
 
-void sequential_fit(cml_sequential *const model, cml_matrix *const x, cml_matrix *const y, fdouble (*learning_rate)(fdouble alpha), const fdouble alpha, const lgint epochs)
+// A itself when it is already of type `dtype`, a converted copy otherwise
+static cml_matrix *sequential_input(cml_matrix *const a, const cml_dtype dtype)
+{
+    return (a->dtype == dtype) ? a : cml_matrix_cast(a, dtype);
+}
+
+// training loop, X and Y are of the type of the model
+static void sequential_train(cml_sequential *const model, const struct sequential_batch *x, cml_matrix *const y, fdouble (*learning_rate)(fdouble alpha), const fdouble alpha, const lgint epochs)
 {
-    if (model == NULL || x == NULL || y == NULL)
-        return;
     struct sequential *sequential = (struct sequential *)model;
-    if (!sequential->is_compiled)
-    {
-        fprintf(stderr, "Error (sequential_fit): the model should be compiled first.\n");
-        return;
-    }
-    if (x == NULL)
-    {
-        fprintf(stderr, "Error (sequential_fit): the input [x] is null\n");
-        return;
-    }
-    if (y == NULL)
+
+    // gradient buffers are allocated once for the whole training, from the
+    // pool so that the next training of the model finds them ready
+    cml_matrix *grads_w[model->n_layers];
+    cml_matrix *grads_b[model->n_layers];
+    for (lgint n = 0; n < model->n_layers; n++)
     {
-        fprintf(stderr, "Error (sequential_fit): the output [y] is null\n");
-        return;
+        cml_layer *layer = model->layers[n];
+        cml_matrix *W = layer->weight(layer);
+        grads_w[n] = cml_matrix_alloc_with(sequential->pool, W->m, W->n, model->dtype);
+        grads_b[n] = cml_matrix_alloc_with(sequential->pool, W->n, 1, model->dtype);
     }
 
     fdouble rate = alpha;
     for (lgint e = 0; e < epochs; e++)
     {
+        // the temporaries of the previous epoch are reclaimed at once
+        sequential->arena->reset(sequential->arena);
+
         // feed forward
         cml_matrix *inputs[model->n_layers];
-        sequential_forward(model, x, inputs);
+        cml_matrix *grads[model->n_layers];
+        sequential_forward(model, x, inputs, grads);
 
         // backward
         rate = learning_rate(rate);
-        sequential_backward(model, x, inputs, y, rate);
+        sequential_backward(model, x, inputs, grads, y, rate, grads_w, grads_b);
 
         for (lgint n = 0; n < model->n_layers; n++)
         {
-            inputs[n]->free(&inputs[n]);
+            inputs[n]->vt->free(&inputs[n]);
         }
 
         fdouble loss = 0;
@@ -430,6 +485,66 @@ void sequential_fit(cml_sequential *const model, cml_matrix *const x, cml_matrix
         }
         printf("epoch\t%ld/%ld\tlearning rate\t%5.7E\tloss %5.7E\n", e + 1, epochs, rate, loss);
     }
+
+    for (lgint n = 0; n < model->n_layers; n++)
+    {
+        grads_w[n]->vt->free(&grads_w[n]);
+        grads_b[n]->vt->free(&grads_b[n]);
+    }
+}
+
+void sequential_fit(cml_sequential *const model, cml_matrix *const x, cml_matrix *const y, fdouble (*learning_rate)(fdouble alpha), const fdouble alpha, const lgint epochs)
+{
+    if (model == NULL || x == NULL || y == NULL)
+        return;
+    struct sequential *sequential = (struct sequential *)model;
+    if (!sequential->is_compiled)
+    {
+        fprintf(stderr, "Error (sequential_fit): the model should be compiled first.\n");
+        return;
+    }
+    if (x == NULL)
+    {
+        fprintf(stderr, "Error (sequential_fit): the input [x] is null\n");
+        return;
+    }
+    if (y == NULL)
+    {
+        fprintf(stderr, "Error (sequential_fit): the output [y] is null\n");
+        return;
+    }
+
+    cml_matrix *xt = sequential_input(x, model->dtype);
+    cml_matrix *yt = sequential_input(y, model->dtype);
+    const struct sequential_batch batch = {xt, NULL, xt->m};
+    sequential_train(model, &batch, yt, learning_rate, alpha, epochs);
+    if (xt != x)
+        xt->vt->free(&xt);
+    if (yt != y)
+        yt->vt->free(&yt);
+}
+
+void sequential_fit_sparse(cml_sequential *const model, cml_sparse *const x, cml_matrix *const y, fdouble (*learning_rate)(fdouble alpha), const fdouble alpha, const lgint epochs)
+{
+    if (model == NULL || x == NULL || y == NULL)
+        return;
+    struct sequential *sequential = (struct sequential *)model;
+    if (!sequential->is_compiled)
+    {
+        fprintf(stderr, "Error (sequential_fit_sparse): the model should be compiled first.\n");
+        return;
+    }
+
+    cml_sparse *xt = (x->dtype == model->dtype) ? x : cml_sparse_cast(x, model->dtype);
+    if (xt == NULL)
+        return;
+    cml_matrix *yt = sequential_input(y, model->dtype);
+    const struct sequential_batch batch = {NULL, xt, xt->m};
+    sequential_train(model, &batch, yt, learning_rate, alpha, epochs);
+    if (xt != x)
+        xt->free(&xt);
+    if (yt != y)
+        yt->vt->free(&yt);
 }
 
 void sequential_free(cml_sequential **model)
@@ -442,10 +557,46 @@ void sequential_free(cml_sequential **model)
         if (layer != NULL)
             layer->free(&layer);
     }
+    struct sequential *sequential = (struct sequential *)(*model);
+    if (sequential->arena != NULL)
+        sequential->arena->free(&sequential->arena);
+    if (sequential->pool != NULL)
+        sequential->pool->free(&sequential->pool);
+    if (sequential->predict_arena != NULL)
+        sequential->predict_arena->free(&sequential->predict_arena);
+    pthread_mutex_destroy(&sequential->predict_lock);
     free(*model);
     *model = NULL;
 }
 
+// arena of the temporaries of a prediction: the one of the model, reused
+// from call to call, or a private one (`*shared` false) while another thread
+// predicts with it, so that predictions may run concurrently (NULL when the
+// allocation has failed)
+static cml_allocator *sequential_predict_arena(struct sequential *sequential, bool *shared)
+{
+    *shared = pthread_mutex_trylock(&sequential->predict_lock) == 0;
+    if (!*shared)
+        return cml_arena_create(CML_SEQUENTIAL_ARENA);
+    if (sequential->predict_arena == NULL)
+        sequential->predict_arena = cml_arena_create(CML_SEQUENTIAL_ARENA);
+    if (sequential->predict_arena == NULL)
+        pthread_mutex_unlock(&sequential->predict_lock);
+    return sequential->predict_arena;
+}
+
+// the temporaries of a prediction are reclaimed, and the arena of the model is handed back
+static void sequential_predict_release(struct sequential *sequential, cml_allocator *temps, const bool shared)
+{
+    if (!shared)
+    {
+        temps->free(&temps);
+        return;
+    }
+    temps->reset(temps);
+    pthread_mutex_unlock(&sequential->predict_lock);
+}
+
 cml_matrix *sequential_predict(cml_sequential *const model, cml_matrix *const x)
 {
     if (model == NULL || x == NULL)
@@ -456,19 +607,51 @@ cml_matrix *sequential_predict(cml_sequential *const model, cml_matrix *const x)
         fprintf(stderr, "Error (sequential_predict): the model should be compiled first.\n");
         return NULL;
     }
-    cml_matrix *mts[model->n_layers];
-    cml_matrix *a = x;
+    bool shared;
+    cml_allocator *temps = sequential_predict_arena(sequential, &shared);
+    if (temps == NULL)
+        return NULL;
+    cml_matrix *xt = sequential_input(x, model->dtype);
 
-    for (lgint i = 0; i < model->n_layers; i++)
+    // the prediction outlives the call, it is the only matrix not drawn from the arena
+    const struct sequential_batch batch = {xt, NULL, xt->m};
+    cml_matrix *yhat = sequential_eval(model, &batch, temps, NULL);
+    sequential_predict_release(sequential, temps, shared);
+    if (xt != x)
+        xt->vt->free(&xt);
+
+    return yhat;
+}
+
+cml_matrix *sequential_predict_sparse(cml_sequential *const model, cml_sparse *const x)
+{
+    if (model == NULL || x == NULL)
+        return NULL;
+    struct sequential *sequential = (struct sequential *)model;
+    if (!sequential->is_compiled)
     {
-        cml_layer *layer = model->layers[i];
-        mts[i] = layer->eval(layer, a);
-        a = mts[i];
-        if (i > 0)
-            mts[i - 1]->free(&mts[i - 1]);
+        fprintf(stderr, "Error (sequential_predict_sparse): the model should be compiled first.\n");
+        return NULL;
+    }
+    cml_sparse *xt = (x->dtype == model->dtype) ? x : cml_sparse_cast(x, model->dtype);
+    if (xt == NULL)
+        return NULL;
+    bool shared;
+    cml_allocator *temps = sequential_predict_arena(sequential, &shared);
+    if (temps == NULL)
+    {
+        if (xt != x)
+            xt->free(&xt);
+        return NULL;
     }
 
-    return mts[model->n_layers - 1];
+    const struct sequential_batch batch = {NULL, xt, xt->m};
+    cml_matrix *yhat = sequential_eval(model, &batch, temps, NULL);
+    sequential_predict_release(sequential, temps, shared);
+    if (xt != x)
+        xt->free(&xt);
+
+    return yhat;
 }
 
 void sequential_summary(cml_sequential *const model)
@@ -0,0 +1,529 @@
+#include "cml_simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CML_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#define SIMD_CAT(a, b) a##b
+#define SIMD_XCAT(a, b) SIMD_CAT(a, b)
+#define SIMD_NAME(op) SIMD_XCAT(simd_##op##_, SIMD_SUFFIX)
+
+/* portable fallback */
+#define SIMD_SUFFIX scalar
+#define SIMD_TARGET
+#define SIMD_T fdouble
+#define SIMD_VEC fdouble
+#define SIMD_WIDTH 1
+#define SIMD_LOAD(p) (*(p))
+#define SIMD_STORE(p, v) (*(p) = (v))
+#define SIMD_SET1(x) (x)
+#define SIMD_ADD(u, v) ((u) + (v))
+#define SIMD_SUB(u, v) ((u) - (v))
+#define SIMD_MUL(u, v) ((u) * (v))
+#define SIMD_MAX(u, v) (((u) > (v)) ? (u) : (v))
+#define SIMD_MIN(u, v) (((u) < (v)) ? (u) : (v))
+#include "cml_simd_kernels.inc"
+
+#define SIMD_SUFFIX scalar_f32
+#define SIMD_TARGET
+#define SIMD_T float
+#define SIMD_VEC float
+#define SIMD_WIDTH 1
+#define SIMD_LOAD(p) (*(p))
+#define SIMD_STORE(p, v) (*(p) = (v))
+#define SIMD_SET1(x) (x)
+#define SIMD_ADD(u, v) ((u) + (v))
+#define SIMD_SUB(u, v) ((u) - (v))
+#define SIMD_MUL(u, v) ((u) * (v))
+#define SIMD_MAX(u, v) (((u) > (v)) ? (u) : (v))
+#define SIMD_MIN(u, v) (((u) < (v)) ? (u) : (v))
+#include "cml_simd_kernels.inc"
+
+#ifdef CML_SIMD_X86
+
+/* SSE2 */
+#define SIMD_SUFFIX sse2
+#define SIMD_TARGET __attribute__((target("sse2")))
+#define SIMD_T fdouble
+#define SIMD_VEC __m128d
+#define SIMD_WIDTH 2
+#define SIMD_LOAD(p) _mm_loadu_pd(p)
+#define SIMD_STORE(p, v) _mm_storeu_pd(p, v)
+#define SIMD_SET1(x) _mm_set1_pd(x)
+#define SIMD_ADD(u, v) _mm_add_pd(u, v)
+#define SIMD_SUB(u, v) _mm_sub_pd(u, v)
+#define SIMD_MUL(u, v) _mm_mul_pd(u, v)
+#define SIMD_MAX(u, v) _mm_max_pd(u, v)
+#define SIMD_MIN(u, v) _mm_min_pd(u, v)
+#include "cml_simd_kernels.inc"
+
+#define SIMD_SUFFIX sse2_f32
+#define SIMD_TARGET __attribute__((target("sse2")))
+#define SIMD_T float
+#define SIMD_VEC __m128
+#define SIMD_WIDTH 4
+#define SIMD_LOAD(p) _mm_loadu_ps(p)
+#define SIMD_STORE(p, v) _mm_storeu_ps(p, v)
+#define SIMD_SET1(x) _mm_set1_ps(x)
+#define SIMD_ADD(u, v) _mm_add_ps(u, v)
+#define SIMD_SUB(u, v) _mm_sub_ps(u, v)
+#define SIMD_MUL(u, v) _mm_mul_ps(u, v)
+#define SIMD_MAX(u, v) _mm_max_ps(u, v)
+#define SIMD_MIN(u, v) _mm_min_ps(u, v)
+#include "cml_simd_kernels.inc"
+
+/* AVX2 */
+#define SIMD_SUFFIX avx2
+#define SIMD_TARGET __attribute__((target("avx2")))
+#define SIMD_T fdouble
+#define SIMD_VEC __m256d
+#define SIMD_WIDTH 4
+#define SIMD_LOAD(p) _mm256_loadu_pd(p)
+#define SIMD_STORE(p, v) _mm256_storeu_pd(p, v)
+#define SIMD_SET1(x) _mm256_set1_pd(x)
+#define SIMD_ADD(u, v) _mm256_add_pd(u, v)
+#define SIMD_SUB(u, v) _mm256_sub_pd(u, v)
+#define SIMD_MUL(u, v) _mm256_mul_pd(u, v)
+#define SIMD_MAX(u, v) _mm256_max_pd(u, v)
+#define SIMD_MIN(u, v) _mm256_min_pd(u, v)
+#include "cml_simd_kernels.inc"
+
+#define SIMD_SUFFIX avx2_f32
+#define SIMD_TARGET __attribute__((target("avx2")))
+#define SIMD_T float
+#define SIMD_VEC __m256
+#define SIMD_WIDTH 8
+#define SIMD_LOAD(p) _mm256_loadu_ps(p)
+#define SIMD_STORE(p, v) _mm256_storeu_ps(p, v)
+#define SIMD_SET1(x) _mm256_set1_ps(x)
+#define SIMD_ADD(u, v) _mm256_add_ps(u, v)
+#define SIMD_SUB(u, v) _mm256_sub_ps(u, v)
+#define SIMD_MUL(u, v) _mm256_mul_ps(u, v)
+#define SIMD_MAX(u, v) _mm256_max_ps(u, v)
+#define SIMD_MIN(u, v) _mm256_min_ps(u, v)
+#include "cml_simd_kernels.inc"
+
+/* AVX-512 */
+#define SIMD_SUFFIX avx512
+#define SIMD_TARGET __attribute__((target("avx512f")))
+#define SIMD_T fdouble
+#define SIMD_VEC __m512d
+#define SIMD_WIDTH 8
+#define SIMD_LOAD(p) _mm512_loadu_pd(p)
+#define SIMD_STORE(p, v) _mm512_storeu_pd(p, v)
+#define SIMD_SET1(x) _mm512_set1_pd(x)
+#define SIMD_ADD(u, v) _mm512_add_pd(u, v)
+#define SIMD_SUB(u, v) _mm512_sub_pd(u, v)
+#define SIMD_MUL(u, v) _mm512_mul_pd(u, v)
+#define SIMD_MAX(u, v) _mm512_max_pd(u, v)
+#define SIMD_MIN(u, v) _mm512_min_pd(u, v)
+#include "cml_simd_kernels.inc"
+
+#define SIMD_SUFFIX avx512_f32
+#define SIMD_TARGET __attribute__((target("avx512f")))
+#define SIMD_T float
+#define SIMD_VEC __m512
+#define SIMD_WIDTH 16
+#define SIMD_LOAD(p) _mm512_loadu_ps(p)
+#define SIMD_STORE(p, v) _mm512_storeu_ps(p, v)
+#define SIMD_SET1(x) _mm512_set1_ps(x)
+#define SIMD_ADD(u, v) _mm512_add_ps(u, v)
+#define SIMD_SUB(u, v) _mm512_sub_ps(u, v)
+#define SIMD_MUL(u, v) _mm512_mul_ps(u, v)
+#define SIMD_MAX(u, v) _mm512_max_ps(u, v)
+#define SIMD_MIN(u, v) _mm512_min_ps(u, v)
+#include "cml_simd_kernels.inc"
+
+#endif
+
+/*
+ * Out-of-place transposes B(n, m) <= A(m, n)^T of a cache-sized tile: square
+ * blocks of the vector width are transposed in registers, the ragged edges
+ * element by element.
+ */
+
+static void simd_transpose_edges(const lgint m, const lgint n, const lgint mb, const lgint nb,
+                                 const fdouble *a, const lgint lda, fdouble *b, const lgint ldb)
+{
+    for (lgint i = 0; i < m; i++)
+    {
+        for (lgint j = (i < mb) ? nb : 0; j < n; j++)
+        {
+            b[j * ldb + i] = a[i * lda + j];
+        }
+    }
+}
+
+static void simd_transpose_scalar(const lgint m, const lgint n, const fdouble *a, const lgint lda, fdouble *b, const lgint ldb)
+{
+    simd_transpose_edges(m, n, 0, 0, a, lda, b, ldb);
+}
+
+static void simd_transpose_edges_f32(const lgint m, const lgint n, const lgint mb, const lgint nb,
+                                     const float *a, const lgint lda, float *b, const lgint ldb)
+{
+    for (lgint i = 0; i < m; i++)
+    {
+        for (lgint j = (i < mb) ? nb : 0; j < n; j++)
+        {
+            b[j * ldb + i] = a[i * lda + j];
+        }
+    }
+}
+
+static void simd_transpose_scalar_f32(const lgint m, const lgint n, const float *a, const lgint lda, float *b, const lgint ldb)
+{
+    simd_transpose_edges_f32(m, n, 0, 0, a, lda, b, ldb);
+}
+
+#ifdef CML_SIMD_X86
+
+static __attribute__((target("sse2"))) void simd_transpose_sse2(const lgint m, const lgint n, const fdouble *a, const lgint lda, fdouble *b, const lgint ldb)
+{
+    const lgint mb = m & ~(lgint)1, nb = n & ~(lgint)1;
+    for (lgint i = 0; i < mb; i += 2)
+    {
+        for (lgint j = 0; j < nb; j += 2)
+        {
+            const fdouble *s = a + i * lda + j;
+            fdouble *d = b + j * ldb + i;
+            const __m128d r0 = _mm_loadu_pd(s);
+            const __m128d r1 = _mm_loadu_pd(s + lda);
+            _mm_storeu_pd(d, _mm_unpacklo_pd(r0, r1));
+            _mm_storeu_pd(d + ldb, _mm_unpackhi_pd(r0, r1));
+        }
+    }
+    simd_transpose_edges(m, n, mb, nb, a, lda, b, ldb);
+}
+
+static __attribute__((target("avx2"))) void simd_transpose_avx2(const lgint m, const lgint n, const fdouble *a, const lgint lda, fdouble *b, const lgint ldb)
+{
+    const lgint mb = m & ~(lgint)3, nb = n & ~(lgint)3;
+    for (lgint i = 0; i < mb; i += 4)
+    {
+        for (lgint j = 0; j < nb; j += 4)
+        {
+            const fdouble *s = a + i * lda + j;
+            fdouble *d = b + j * ldb + i;
+            const __m256d r0 = _mm256_loadu_pd(s);
+            const __m256d r1 = _mm256_loadu_pd(s + lda);
+            const __m256d r2 = _mm256_loadu_pd(s + 2 * lda);
+            const __m256d r3 = _mm256_loadu_pd(s + 3 * lda);
+            const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+            const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+            const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+            const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+            _mm256_storeu_pd(d, _mm256_permute2f128_pd(t0, t2, 0x20));
+            _mm256_storeu_pd(d + ldb, _mm256_permute2f128_pd(t1, t3, 0x20));
+            _mm256_storeu_pd(d + 2 * ldb, _mm256_permute2f128_pd(t0, t2, 0x31));
+            _mm256_storeu_pd(d + 3 * ldb, _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+    }
+    simd_transpose_edges(m, n, mb, nb, a, lda, b, ldb);
+}
+
+static __attribute__((target("avx512f"))) void simd_transpose_avx512(const lgint m, const lgint n, const fdouble *a, const lgint lda, fdouble *b, const lgint ldb)
+{
+    const lgint mb = m & ~(lgint)7, nb = n & ~(lgint)7;
+    for (lgint i = 0; i < mb; i += 8)
+    {
+        for (lgint j = 0; j < nb; j += 8)
+        {
+            const fdouble *s = a + i * lda + j;
+            fdouble *d = b + j * ldb + i;
+            __m512d t[8];
+            for (int r = 0; r < 8; r += 2)
+            {
+                const __m512d r0 = _mm512_loadu_pd(s + r * lda);
+                const __m512d r1 = _mm512_loadu_pd(s + (r + 1) * lda);
+                // pairs of rows interleaved: the 128-bit lane k holds (a[r][2k], a[r+1][2k]) or the odd column
+                t[r] = _mm512_unpacklo_pd(r0, r1);
+                t[r + 1] = _mm512_unpackhi_pd(r0, r1);
+            }
+            for (int c = 0; c < 2; c++)
+            {
+                // gather the lanes of the even (c = 0) or odd (c = 1) columns
+                const __m512d u0 = _mm512_shuffle_f64x2(t[c], t[c + 2], 0x88);
+                const __m512d u1 = _mm512_shuffle_f64x2(t[c], t[c + 2], 0xDD);
+                const __m512d u2 = _mm512_shuffle_f64x2(t[c + 4], t[c + 6], 0x88);
+                const __m512d u3 = _mm512_shuffle_f64x2(t[c + 4], t[c + 6], 0xDD);
+                _mm512_storeu_pd(d + c * ldb, _mm512_shuffle_f64x2(u0, u2, 0x88));
+                _mm512_storeu_pd(d + (c + 2) * ldb, _mm512_shuffle_f64x2(u1, u3, 0x88));
+                _mm512_storeu_pd(d + (c + 4) * ldb, _mm512_shuffle_f64x2(u0, u2, 0xDD));
+                _mm512_storeu_pd(d + (c + 6) * ldb, _mm512_shuffle_f64x2(u1, u3, 0xDD));
+            }
+        }
+    }
+    simd_transpose_edges(m, n, mb, nb, a, lda, b, ldb);
+}
+
+static __attribute__((target("sse2"))) void simd_transpose_sse2_f32(const lgint m, const lgint n, const float *a, const lgint lda, float *b, const lgint ldb)
+{
+    const lgint mb = m & ~(lgint)3, nb = n & ~(lgint)3;
+    for (lgint i = 0; i < mb; i += 4)
+    {
+        for (lgint j = 0; j < nb; j += 4)
+        {
+            const float *s = a + i * lda + j;
+            float *d = b + j * ldb + i;
+            __m128 r0 = _mm_loadu_ps(s);
+            __m128 r1 = _mm_loadu_ps(s + lda);
+            __m128 r2 = _mm_loadu_ps(s + 2 * lda);
+            __m128 r3 = _mm_loadu_ps(s + 3 * lda);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(d, r0);
+            _mm_storeu_ps(d + ldb, r1);
+            _mm_storeu_ps(d + 2 * ldb, r2);
+            _mm_storeu_ps(d + 3 * ldb, r3);
+        }
+    }
+    simd_transpose_edges_f32(m, n, mb, nb, a, lda, b, ldb);
+}
+
+static __attribute__((target("avx2"))) void simd_transpose_avx2_f32(const lgint m, const lgint n, const float *a, const lgint lda, float *b, const lgint ldb)
+{
+    const lgint mb = m & ~(lgint)7, nb = n & ~(lgint)7;
+    for (lgint i = 0; i < mb; i += 8)
+    {
+        for (lgint j = 0; j < nb; j += 8)
+        {
+            const float *s = a + i * lda + j;
+            float *d = b + j * ldb + i;
+            __m256 r[8], t[8];
+            for (int k = 0; k < 8; k++)
+                r[k] = _mm256_loadu_ps(s + k * lda);
+            for (int k = 0; k < 8; k += 2)
+            {
+                t[k] = _mm256_unpacklo_ps(r[k], r[k + 1]);
+                t[k + 1] = _mm256_unpackhi_ps(r[k], r[k + 1]);
+            }
+            // 4x4 blocks within each 128-bit lane, then the lanes are exchanged
+            for (int k = 0; k < 8; k += 4)
+            {
+                r[k] = _mm256_shuffle_ps(t[k], t[k + 2], 0x44);
+                r[k + 1] = _mm256_shuffle_ps(t[k], t[k + 2], 0xEE);
+                r[k + 2] = _mm256_shuffle_ps(t[k + 1], t[k + 3], 0x44);
+                r[k + 3] = _mm256_shuffle_ps(t[k + 1], t[k + 3], 0xEE);
+            }
+            for (int k = 0; k < 4; k++)
+            {
+                _mm256_storeu_ps(d + k * ldb, _mm256_permute2f128_ps(r[k], r[k + 4], 0x20));
+                _mm256_storeu_ps(d + (k + 4) * ldb, _mm256_permute2f128_ps(r[k], r[k + 4], 0x31));
+            }
+        }
+    }
+    simd_transpose_edges_f32(m, n, mb, nb, a, lda, b, ldb);
+}
+
+// 8x8 blocks already fill a 32x32 float tile evenly, 16x16 ones buy nothing
+static __attribute__((target("avx512f"))) void simd_transpose_avx512_f32(const lgint m, const lgint n, const float *a, const lgint lda, float *b, const lgint ldb)
+{
+    simd_transpose_avx2_f32(m, n, a, lda, b, ldb);
+}
+
+#endif
+
+struct simd_kernels
+{
+    const char *name;
+    void (*add)(const lgint n, const fdouble *x, const fdouble *y, fdouble *z);
+    void (*sub)(const lgint n, const fdouble *x, const fdouble *y, fdouble *z);
+    void (*mul)(const lgint n, const fdouble *x, const fdouble *y, fdouble *z);
+    void (*scale)(const lgint n, const fdouble alpha, const fdouble *x, fdouble *z);
+    void (*axpy)(const lgint n, const fdouble alpha, const fdouble *x, fdouble *y);
+    void (*transpose)(const lgint m, const lgint n, const fdouble *a, const lgint lda, fdouble *b, const lgint ldb);
+    void (*max)(const lgint n, const fdouble *x, const fdouble *y, fdouble *z);
+    void (*min)(const lgint n, const fdouble *x, const fdouble *y, fdouble *z);
+    fdouble (*sum)(const lgint n, const fdouble *x);
+    fdouble (*dot)(const lgint n, const fdouble *x, const fdouble *y);
+    fdouble (*maxval)(const lgint n, const fdouble *x);
+    fdouble (*minval)(const lgint n, const fdouble *x);
+
+    void (*add_f32)(const lgint n, const float *x, const float *y, float *z);
+    void (*sub_f32)(const lgint n, const float *x, const float *y, float *z);
+    void (*mul_f32)(const lgint n, const float *x, const float *y, float *z);
+    void (*scale_f32)(const lgint n, const float alpha, const float *x, float *z);
+    void (*axpy_f32)(const lgint n, const float alpha, const float *x, float *y);
+    void (*transpose_f32)(const lgint m, const lgint n, const float *a, const lgint lda, float *b, const lgint ldb);
+    void (*max_f32)(const lgint n, const float *x, const float *y, float *z);
+    void (*min_f32)(const lgint n, const float *x, const float *y, float *z);
+    float (*sum_f32)(const lgint n, const float *x);
+    float (*dot_f32)(const lgint n, const float *x, const float *y);
+    float (*maxval_f32)(const lgint n, const float *x);
+    float (*minval_f32)(const lgint n, const float *x);
+};
+
+#define SIMD_KERNELS(suffix) \
+    {#suffix, &simd_add_##suffix, &simd_sub_##suffix, &simd_mul_##suffix, &simd_scale_##suffix, &simd_axpy_##suffix, \
+     &simd_transpose_##suffix, &simd_max_##suffix, &simd_min_##suffix, &simd_sum_##suffix, &simd_dot_##suffix, \
+     &simd_maxval_##suffix, &simd_minval_##suffix, \
+     &simd_add_##suffix##_f32, &simd_sub_##suffix##_f32, &simd_mul_##suffix##_f32, &simd_scale_##suffix##_f32, \
+     &simd_axpy_##suffix##_f32, &simd_transpose_##suffix##_f32, &simd_max_##suffix##_f32, &simd_min_##suffix##_f32, \
+     &simd_sum_##suffix##_f32, &simd_dot_##suffix##_f32, &simd_maxval_##suffix##_f32, &simd_minval_##suffix##_f32}
+
+static const struct simd_kernels simd_scalar = SIMD_KERNELS(scalar);
+#ifdef CML_SIMD_X86
+static const struct simd_kernels simd_sse2 = SIMD_KERNELS(sse2);
+static const struct simd_kernels simd_avx2 = SIMD_KERNELS(avx2);
+static const struct simd_kernels simd_avx512 = SIMD_KERNELS(avx512);
+#endif
+
+static const struct simd_kernels *simd = &simd_scalar;
+
+// pick the widest instruction set supported by the CPU, the environment
+// variable CML_SIMD (scalar, sse2, avx2 or avx512) may lower the choice
+__attribute__((constructor)) static void simd_init(void)
+{
+#ifdef CML_SIMD_X86
+    int level = 3;
+    const char *cap = getenv("CML_SIMD");
+    if (cap != NULL)
+    {
+        if (strcmp(cap, "avx2") == 0)
+            level = 2;
+        else if (strcmp(cap, "sse2") == 0)
+            level = 1;
+        else if (strcmp(cap, "scalar") == 0)
+            level = 0;
+    }
+
+    __builtin_cpu_init();
+    if (level >= 3 && __builtin_cpu_supports("avx512f"))
+        simd = &simd_avx512;
+    else if (level >= 2 && __builtin_cpu_supports("avx2"))
+        simd = &simd_avx2;
+    else if (level >= 1 && __builtin_cpu_supports("sse2"))
+        simd = &simd_sse2;
+    else
+        simd = &simd_scalar;
+#endif
+}
+
+void cml_vec_add(const lgint n, const fdouble *x, const fdouble *y, fdouble *z)
+{
+    simd->add(n, x, y, z);
+}
+
+void cml_vec_sub(const lgint n, const fdouble *x, const fdouble *y, fdouble *z)
+{
+    simd->sub(n, x, y, z);
+}
+
+void cml_vec_mul(const lgint n, const fdouble *x, const fdouble *y, fdouble *z)
+{
+    simd->mul(n, x, y, z);
+}
+
+void cml_vec_scale(const lgint n, const fdouble alpha, const fdouble *x, fdouble *z)
+{
+    simd->scale(n, alpha, x, z);
+}
+
+void cml_vec_axpy(const lgint n, const fdouble alpha, const fdouble *x, fdouble *y)
+{
+    simd->axpy(n, alpha, x, y);
+}
+
+void cml_vec_transpose(const lgint m, const lgint n, const fdouble *a, const lgint lda, fdouble *b, const lgint ldb)
+{
+    simd->transpose(m, n, a, lda, b, ldb);
+}
+
+void cml_vec_max(const lgint n, const fdouble *x, const fdouble *y, fdouble *z)
+{
+    simd->max(n, x, y, z);
+}
+
+void cml_vec_min(const lgint n, const fdouble *x, const fdouble *y, fdouble *z)
+{
+    simd->min(n, x, y, z);
+}
+
+fdouble cml_vec_sum(const lgint n, const fdouble *x)
+{
+    return simd->sum(n, x);
+}
+
+fdouble cml_vec_dot(const lgint n, const fdouble *x, const fdouble *y)
+{
+    return simd->dot(n, x, y);
+}
+
+fdouble cml_vec_maxval(const lgint n, const fdouble *x)
+{
+    return simd->maxval(n, x);
+}
+
+fdouble cml_vec_minval(const lgint n, const fdouble *x)
+{
+    return simd->minval(n, x);
+}
+
+void cml_vec_add_f32(const lgint n, const float *x, const float *y, float *z)
+{
+    simd->add_f32(n, x, y, z);
+}
+
+void cml_vec_sub_f32(const lgint n, const float *x, const float *y, float *z)
+{
+    simd->sub_f32(n, x, y, z);
+}
+
+void cml_vec_mul_f32(const lgint n, const float *x, const float *y, float *z)
+{
+    simd->mul_f32(n, x, y, z);
+}
+
+void cml_vec_scale_f32(const lgint n, const float alpha, const float *x, float *z)
+{
+    simd->scale_f32(n, alpha, x, z);
+}
+
+void cml_vec_axpy_f32(const lgint n, const float alpha, const float *x, float *y)
+{
+    simd->axpy_f32(n, alpha, x, y);
+}
+
+void cml_vec_transpose_f32(const lgint m, const lgint n, const float *a, const lgint lda, float *b, const lgint ldb)
+{
+    simd->transpose_f32(m, n, a, lda, b, ldb);
+}
+
+void cml_vec_max_f32(const lgint n, const float *x, const float *y, float *z)
+{
+    simd->max_f32(n, x, y, z);
+}
+
+void cml_vec_min_f32(const lgint n, const float *x, const float *y, float *z)
+{
+    simd->min_f32(n, x, y, z);
+}
+
+float cml_vec_sum_f32(const lgint n, const float *x)
+{
+    return simd->sum_f32(n, x);
+}
+
+float cml_vec_dot_f32(const lgint n, const float *x, const float *y)
+{
+    return simd->dot_f32(n, x, y);
+}
+
+float cml_vec_maxval_f32(const lgint n, const float *x)
+{
+    return simd->maxval_f32(n, x);
+}
+
+float cml_vec_minval_f32(const lgint n, const float *x)
+{
+    return simd->minval_f32(n, x);
+}
+
+const char *cml_simd_name(void)
+{
+    return simd->name;
+}
@@ -0,0 +1,72 @@
+#ifndef cml_simd_h
+#define cml_simd_h
+
+#include "cml_matrix.h"
+
+// Element-wise kernels over contiguous arrays of `n` values. The output may
+// alias any of the inputs. The instruction set (AVX-512, AVX2, SSE2 or plain C)
+// is picked once when the library is loaded.
+
+// z <= x + y
+void cml_vec_add(const lgint n, const fdouble *x, const fdouble *y, fdouble *z);
+
+// z <= x - y
+void cml_vec_sub(const lgint n, const fdouble *x, const fdouble *y, fdouble *z);
+
+// z <= x * y (element-wise)
+void cml_vec_mul(const lgint n, const fdouble *x, const fdouble *y, fdouble *z);
+
+// z <= alpha * x
+void cml_vec_scale(const lgint n, const fdouble alpha, const fdouble *x, fdouble *z);
+
+// y <= alpha * x + y
+void cml_vec_axpy(const lgint n, const fdouble alpha, const fdouble *x, fdouble *y);
+
+// B(n, m) <= A(m, n)^T for a tile small enough to stay in cache, A and B
+// have the leading dimensions `lda` and `ldb` and do not overlap
+void cml_vec_transpose(const lgint m, const lgint n, const fdouble *a, const lgint lda, fdouble *b, const lgint ldb);
+
+// z <= max(x, y) and z <= min(x, y) (element-wise)
+void cml_vec_max(const lgint n, const fdouble *x, const fdouble *y, fdouble *z);
+
+void cml_vec_min(const lgint n, const fdouble *x, const fdouble *y, fdouble *z);
+
+// sum of x, and of x * y
+fdouble cml_vec_sum(const lgint n, const fdouble *x);
+
+fdouble cml_vec_dot(const lgint n, const fdouble *x, const fdouble *y);
+
+// largest and smallest of the n >= 1 values of x
+fdouble cml_vec_maxval(const lgint n, const fdouble *x);
+
+fdouble cml_vec_minval(const lgint n, const fdouble *x);
+
+// single-precision counterparts, twice as many elements per vector
+void cml_vec_add_f32(const lgint n, const float *x, const float *y, float *z);
+
+void cml_vec_sub_f32(const lgint n, const float *x, const float *y, float *z);
+
+void cml_vec_mul_f32(const lgint n, const float *x, const float *y, float *z);
+
+void cml_vec_scale_f32(const lgint n, const float alpha, const float *x, float *z);
+
+void cml_vec_axpy_f32(const lgint n, const float alpha, const float *x, float *y);
+
+void cml_vec_transpose_f32(const lgint m, const lgint n, const float *a, const lgint lda, float *b, const lgint ldb);
+
+void cml_vec_max_f32(const lgint n, const float *x, const float *y, float *z);
+
+void cml_vec_min_f32(const lgint n, const float *x, const float *y, float *z);
+
+float cml_vec_sum_f32(const lgint n, const float *x);
+
+float cml_vec_dot_f32(const lgint n, const float *x, const float *y);
+
+float cml_vec_maxval_f32(const lgint n, const float *x);
+
+float cml_vec_minval_f32(const lgint n, const float *x);
+
+// name of the selected instruction set
+const char *cml_simd_name(void);
+
+#endif
@@ -0,0 +1,377 @@
+#include "cml_sparse.h"
+#include "cml_matrix_impl.h"
+#include "cml_pool.h"
+#include "cml_simd.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// number of multiply-adds below which a product runs on a single thread
+#define SPARSE_GRAIN 16384
+
+// number of columns of C updated by one task of the transposed product
+#define SPARSE_COLUMNS 64
+
+struct sparse
+{
+    /* Public interface */
+    cml_sparse pub;
+
+    /* Elements of row i are values[rows[i]:rows[i + 1]], in the columns cols[...], of type dtype */
+    lgint *rows;
+    lgint *cols;
+    void *values;
+};
+
+static void sparse_free(cml_sparse **a);
+static fdouble sparse_get(cml_sparse *const a, const lgint i, const lgint j);
+static void sparse_print(cml_sparse *const a);
+static cml_matrix *sparse_to_dense(cml_sparse *const a);
+
+// sparse matrix (m, n) with room for `nnz` elements, the arrays are not filled
+static struct sparse *sparse_alloc(const lgint m, const lgint n, const lgint nnz, const cml_dtype dtype)
+{
+    struct sparse *a = (struct sparse *)malloc(sizeof(*a));
+    if (a == NULL)
+        return NULL;
+    *(lgint *)(&a->pub.m) = m;
+    *(lgint *)(&a->pub.n) = n;
+    *(lgint *)(&a->pub.nnz) = nnz;
+    *(cml_dtype *)(&a->pub.dtype) = dtype;
+
+    a->pub.free = &sparse_free;
+    a->pub.get = &sparse_get;
+    a->pub.print = &sparse_print;
+    a->pub.to_dense = &sparse_to_dense;
+
+    const size_t elsize = (dtype == FLOAT32) ? sizeof(float) : sizeof(fdouble);
+    a->rows = (lgint *)malloc((m + 1) * sizeof(*a->rows));
+    a->cols = (lgint *)malloc((nnz + 1) * sizeof(*a->cols));
+    a->values = malloc((nnz + 1) * elsize);
+    if (a->rows == NULL || a->cols == NULL || a->values == NULL)
+    {
+        cml_sparse *self = &a->pub;
+        sparse_free(&self);
+        return NULL;
+    }
+    return a;
+}
+
+static inline fdouble sparse_value(struct sparse *const a, const lgint p)
+{
+    if (a->pub.dtype == FLOAT32)
+        return ((float *)a->values)[p];
+    return ((fdouble *)a->values)[p];
+}
+
+static inline void sparse_store(struct sparse *const a, const lgint p, const fdouble value)
+{
+    if (a->pub.dtype == FLOAT32)
+        ((float *)a->values)[p] = (float)value;
+    else
+        ((fdouble *)a->values)[p] = value;
+}
+
+cml_sparse *cml_sparse_cast(cml_sparse *const a, const cml_dtype dtype)
+{
+    if (a == NULL)
+    {
+        fprintf(stderr, "error (cml_sparse_cast): the matrix is null.\n");
+        return NULL;
+    }
+    struct sparse *src = (struct sparse *)a;
+    struct sparse *dst = sparse_alloc(a->m, a->n, a->nnz, dtype);
+    if (dst == NULL)
+    {
+        fprintf(stderr, "error (cml_sparse_cast): the allocation memory has failed.\n");
+        return NULL;
+    }
+    memcpy(dst->rows, src->rows, (a->m + 1) * sizeof(*dst->rows));
+    memcpy(dst->cols, src->cols, a->nnz * sizeof(*dst->cols));
+    for (lgint p = 0; p < a->nnz; p++)
+    {
+        sparse_store(dst, p, sparse_value(src, p));
+    }
+    return &dst->pub;
+}
+
+cml_sparse *cml_sparse_create(const lgint m, const lgint n, const lgint *rows, const lgint *cols, const fdouble *values, const cml_dtype dtype)
+{
+    if (rows == NULL || (rows[m] > 0 && (cols == NULL || values == NULL)))
+    {
+        fprintf(stderr, "error (cml_sparse_create): an array is null.\n");
+        return NULL;
+    }
+    if (rows[0] != 0)
+    {
+        fprintf(stderr, "error (cml_sparse_create): the first row should start at 0.\n");
+        return NULL;
+    }
+    for (lgint i = 0; i < m; i++)
+    {
+        if (rows[i + 1] < rows[i])
+        {
+            fprintf(stderr, "error (cml_sparse_create): the row offsets should be non-decreasing.\n");
+            return NULL;
+        }
+        for (lgint p = rows[i]; p < rows[i + 1]; p++)
+        {
+            if (cols[p] >= n || (p > rows[i] && cols[p] <= cols[p - 1]))
+            {
+                fprintf(stderr, "error (cml_sparse_create): the columns of the row %ld should be increasing and less than %ld.\n", i, n);
+                return NULL;
+            }
+        }
+    }
+
+    struct sparse *a = sparse_alloc(m, n, rows[m], dtype);
+    if (a == NULL)
+    {
+        fprintf(stderr, "error (cml_sparse_create): the allocation memory has failed.\n");
+        return NULL;
+    }
+    memcpy(a->rows, rows, (m + 1) * sizeof(*a->rows));
+    memcpy(a->cols, cols, rows[m] * sizeof(*a->cols));
+    for (lgint p = 0; p < rows[m]; p++)
+    {
+        sparse_store(a, p, values[p]);
+    }
+    return &a->pub;
+}
+
+cml_sparse *cml_sparse_from_dense(cml_matrix *const a)
+{
+    if (a == NULL)
+    {
+        fprintf(stderr, "error (cml_sparse_from_dense): the matrix is null.\n");
+        return NULL;
+    }
+    lgint nnz = 0;
+    for (lgint i = 0; i < a->m; i++)
+    {
+        for (lgint j = 0; j < a->n; j++)
+        {
+            if (matrix_load(a, i, j) != 0.)
+                nnz++;
+        }
+    }
+
+    struct sparse *s = sparse_alloc(a->m, a->n, nnz, a->dtype);
+    if (s == NULL)
+    {
+        fprintf(stderr, "error (cml_sparse_from_dense): the allocation memory has failed.\n");
+        return NULL;
+    }
+    lgint p = 0;
+    for (lgint i = 0; i < a->m; i++)
+    {
+        s->rows[i] = p;
+        for (lgint j = 0; j < a->n; j++)
+        {
+            const fdouble value = matrix_load(a, i, j);
+            if (value != 0.)
+            {
+                s->cols[p] = j;
+                sparse_store(s, p, value);
+                p++;
+            }
+        }
+    }
+    s->rows[a->m] = p;
+    return &s->pub;
+}
+
+// operands of C <= alpha*op(A)*B + beta*C
+struct sparse_product
+{
+    struct sparse *a;
+    cml_matrix *b;
+    cml_matrix *c;
+    fdouble alpha;
+    fdouble beta;
+};
+
+// columns [begin, end) of the row of C at `crow`: beta*C, C is not read when beta is 0
+static void sparse_scale(const cml_dtype dtype, void *crow, const lgint begin, const lgint end, const fdouble beta)
+{
+    if (beta == 1.)
+        return;
+    if (dtype == FLOAT32)
+    {
+        float *c = (float *)crow + begin;
+        if (beta == 0.)
+            memset(c, 0, (end - begin) * sizeof(*c));
+        else
+            cml_vec_scale_f32(end - begin, (float)beta, c, c);
+    }
+    else
+    {
+        fdouble *c = (fdouble *)crow + begin;
+        if (beta == 0.)
+            memset(c, 0, (end - begin) * sizeof(*c));
+        else
+            cml_vec_scale(end - begin, beta, c, c);
+    }
+}
+
+// columns [begin, end) of the row of C at `crow` += alpha*(row of B at `brow`)
+static void sparse_axpy(const cml_dtype dtype, void *crow, const void *brow, const lgint begin, const lgint end, const fdouble alpha)
+{
+    if (dtype == FLOAT32)
+        cml_vec_axpy_f32(end - begin, (float)alpha, (const float *)brow + begin, (float *)crow + begin);
+    else
+        cml_vec_axpy(end - begin, alpha, (const fdouble *)brow + begin, (fdouble *)crow + begin);
+}
+
+// rows [begin, end) of C <= alpha*A*B + beta*C, each one a sum of the rows of B picked by A
+static void sparse_gemm_task(void *ctx, const lgint begin, const lgint end)
+{
+    struct sparse_product *op = (struct sparse_product *)ctx;
+    const struct sparse *a = op->a;
+    const lgint n = op->c->n;
+    for (lgint i = begin; i < end; i++)
+    {
+        void *crow = matrix_ptr(op->c, i, 0);
+        sparse_scale(op->c->dtype, crow, 0, n, op->beta);
+        for (lgint p = a->rows[i]; p < a->rows[i + 1]; p++)
+        {
+            sparse_axpy(op->c->dtype, crow, matrix_ptr(op->b, a->cols[p], 0), 0, n, op->alpha * sparse_value(op->a, p));
+        }
+    }
+}
+
+// columns [begin, end) of C <= alpha*A^T*B + beta*C: the row i of B is
+// scattered into the rows of C picked by the row i of A, so that the tasks
+// own disjoint columns of C
+static void sparse_gemm_trans_task(void *ctx, const lgint begin, const lgint end)
+{
+    struct sparse_product *op = (struct sparse_product *)ctx;
+    const struct sparse *a = op->a;
+    for (lgint r = 0; r < op->c->m; r++)
+    {
+        sparse_scale(op->c->dtype, matrix_ptr(op->c, r, 0), begin, end, op->beta);
+    }
+    for (lgint i = 0; i < a->pub.m; i++)
+    {
+        const void *brow = matrix_ptr(op->b, i, 0);
+        for (lgint p = a->rows[i]; p < a->rows[i + 1]; p++)
+        {
+            sparse_axpy(op->c->dtype, matrix_ptr(op->c, a->cols[p], 0), brow, begin, end, op->alpha * sparse_value(op->a, p));
+        }
+    }
+}
+
+cml_matrix *cml_sparse_gemm(const bool trans_a, const fdouble alpha, cml_sparse *const a, cml_matrix *const b, const fdouble beta, cml_matrix *c)
+{
+    if (a == NULL || b == NULL || c == NULL)
+    {
+        fprintf(stderr, "error (cml_sparse_gemm): a matrix is null in C=alpha*op(A)*B+beta*C.\n");
+        return NULL;
+    }
+    const lgint m = trans_a ? a->n : a->m;
+    const lgint k = trans_a ? a->m : a->n;
+    if (k != b->m || c->m != m || c->n != b->n)
+    {
+        fprintf(stderr, "error (cml_sparse_gemm): the matrices (%ld, %ld) and (%ld, %ld) are not product compatible with C (%ld, %ld).\n", m, k, b->m, b->n, c->m, c->n);
+        return NULL;
+    }
+    if (a->dtype != b->dtype || a->dtype != c->dtype)
+    {
+        fprintf(stderr, "error (cml_sparse_gemm): the matrices should be of same dtype.\n");
+        return NULL;
+    }
+    if (matrix_overlap(c, b))
+    {
+        fprintf(stderr, "error (cml_sparse_gemm): C can not overlap an operand.\n");
+        return NULL;
+    }
+    if (matrix_unshare(c, beta != 0.) == NULL)
+        return NULL;
+
+    struct sparse_product op = {(struct sparse *)a, b, c, alpha, beta};
+    if (trans_a)
+    {
+        const lgint work = (a->nnz + c->m) * SPARSE_COLUMNS;
+        cml_pool_run(c->n, (work < SPARSE_GRAIN) ? c->n : SPARSE_COLUMNS, &sparse_gemm_trans_task, &op);
+    }
+    else
+    {
+        const lgint work = (1 + a->nnz / (a->m + 1)) * c->n;
+        cml_pool_run(c->m, 1 + SPARSE_GRAIN / work, &sparse_gemm_task, &op);
+    }
+    return c;
+}
+
+void sparse_free(cml_sparse **self)
+{
+    if (*self == NULL)
+        return;
+    struct sparse *a = (struct sparse *)(*self);
+    free(a->rows);
+    free(a->cols);
+    free(a->values);
+    free(a);
+    *self = NULL;
+}
+
+fdouble sparse_get(cml_sparse *const self, const lgint i, const lgint j)
+{
+    if (self == NULL)
+        return 0.;
+    if (self->m <= i || self->n <= j)
+    {
+        fprintf(stderr, "Error (sparse_get): the index (%ld, %ld) is outside of the matrix dimension (%ld, %ld)\n", i, j, self->m, self->n);
+        return 0.;
+    }
+    // binary search of the column among the increasing columns of the row
+    struct sparse *a = (struct sparse *)self;
+    lgint lo = a->rows[i], hi = a->rows[i + 1];
+    while (lo < hi)
+    {
+        const lgint mid = lo + (hi - lo) / 2;
+        if (a->cols[mid] < j)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return (lo < a->rows[i + 1] && a->cols[lo] == j) ? sparse_value(a, lo) : 0.;
+}
+
+void sparse_print(cml_sparse *const self)
+{
+    if (self == NULL)
+        return;
+    struct sparse *a = (struct sparse *)self;
+    printf("Sparse(%ld, %ld) with %ld elements = \n", self->m, self->n, self->nnz);
+    printf("[\n");
+    for (lgint i = 0; i < self->m; i++)
+    {
+        for (lgint p = a->rows[i]; p < a->rows[i + 1]; p++)
+        {
+            printf("   (%ld, %ld) %lg\n", i, a->cols[p], sparse_value(a, p));
+        }
+    }
+    printf("]\n");
+}
+
+cml_matrix *sparse_to_dense(cml_sparse *const self)
+{
+    if (self == NULL)
+        return NULL;
+    struct sparse *a = (struct sparse *)self;
+    cml_matrix *d = cml_matrix_zeros_dtype(self->m, self->n, self->dtype);
+    if (d == NULL)
+    {
+        fprintf(stderr, "error (sparse_to_dense): the allocation memory has failed.\n");
+        return NULL;
+    }
+    for (lgint i = 0; i < self->m; i++)
+    {
+        for (lgint p = a->rows[i]; p < a->rows[i + 1]; p++)
+        {
+            matrix_store(d, i, a->cols[p], sparse_value(a, p));
+        }
+    }
+    return d;
+}
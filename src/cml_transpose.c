@@ -0,0 +1,142 @@
+#include "cml_transpose.h"
+#include "cml_pool.h"
+#include "cml_simd.h"
+
+#include <string.h>
+
+// side of the tiles transposed in registers, two tiles fit in L1
+#define TRANSPOSE_TILE 32
+
+// number of elements below which a transpose runs on a single thread
+#define TRANSPOSE_GRAIN 16384
+
+// tile kernel for one element type, the leading dimensions count elements
+typedef void transpose_tile(const lgint m, const lgint n, const void *a, const lgint lda, void *b, const lgint ldb);
+
+static void transpose_tile_f64(const lgint m, const lgint n, const void *a, const lgint lda, void *b, const lgint ldb)
+{
+    cml_vec_transpose(m, n, (const fdouble *)a, lda, (fdouble *)b, ldb);
+}
+
+static void transpose_tile_f32(const lgint m, const lgint n, const void *a, const lgint lda, void *b, const lgint ldb)
+{
+    cml_vec_transpose_f32(m, n, (const float *)a, lda, (float *)b, ldb);
+}
+
+struct transpose_args
+{
+    lgint m, n;
+    char *a;
+    lgint lda;
+    char *b;
+    lgint ldb;
+    size_t size;
+    transpose_tile *tile;
+};
+
+// cache-oblivious recursion: halve the longest side until the block is a tile,
+// the cut is rounded to a multiple of 8 to keep whole SIMD blocks
+static void transpose_rec(const struct transpose_args *t, const lgint m, const lgint n, const char *a, char *b)
+{
+    if (m <= TRANSPOSE_TILE && n <= TRANSPOSE_TILE)
+    {
+        t->tile(m, n, a, t->lda, b, t->ldb);
+    }
+    else if (m >= n)
+    {
+        const lgint h = (m / 2 + 7) & ~(lgint)7;
+        transpose_rec(t, h, n, a, b);
+        transpose_rec(t, m - h, n, a + h * t->lda * t->size, b + h * t->size);
+    }
+    else
+    {
+        const lgint h = (n / 2 + 7) & ~(lgint)7;
+        transpose_rec(t, m, h, a, b);
+        transpose_rec(t, m, n - h, a + h * t->size, b + h * t->ldb * t->size);
+    }
+}
+
+// rows [begin, end) of A
+static void transpose_rows_task(void *ctx, const lgint begin, const lgint end)
+{
+    struct transpose_args *t = (struct transpose_args *)ctx;
+    transpose_rec(t, end - begin, t->n, t->a + begin * t->lda * t->size, t->b + begin * t->size);
+}
+
+// columns [begin, end) of A
+static void transpose_cols_task(void *ctx, const lgint begin, const lgint end)
+{
+    struct transpose_args *t = (struct transpose_args *)ctx;
+    transpose_rec(t, t->m, end - begin, t->a + begin * t->size, t->b + begin * t->ldb * t->size);
+}
+
+static void transpose(struct transpose_args *t)
+{
+    if (t->m == 0 || t->n == 0)
+        return;
+    // the threads share the longest side
+    if (t->m >= t->n)
+        cml_pool_run(t->m, TRANSPOSE_TILE + TRANSPOSE_GRAIN / t->n, &transpose_rows_task, t);
+    else
+        cml_pool_run(t->n, TRANSPOSE_TILE + TRANSPOSE_GRAIN / t->m, &transpose_cols_task, t);
+}
+
+void cml_transpose(const lgint m, const lgint n, const fdouble *a, const lgint lda, fdouble *b, const lgint ldb)
+{
+    struct transpose_args t = {m, n, (char *)a, lda, (char *)b, ldb, sizeof(*a), &transpose_tile_f64};
+    transpose(&t);
+}
+
+void cml_transpose_f32(const lgint m, const lgint n, const float *a, const lgint lda, float *b, const lgint ldb)
+{
+    struct transpose_args t = {m, n, (char *)a, lda, (char *)b, ldb, sizeof(*a), &transpose_tile_f32};
+    transpose(&t);
+}
+
+// tile rows [begin, end): each tile (I, J) with I <= J is swapped with its mirror
+static void transpose_square_task(void *ctx, const lgint begin, const lgint end)
+{
+    struct transpose_args *t = (struct transpose_args *)ctx;
+    fdouble tmp[TRANSPOSE_TILE * TRANSPOSE_TILE];
+    const lgint lda = t->lda * t->size;
+    for (lgint ib = begin; ib < end; ib++)
+    {
+        const lgint i = ib * TRANSPOSE_TILE;
+        const lgint mi = (t->n - i < TRANSPOSE_TILE) ? t->n - i : TRANSPOSE_TILE;
+        for (lgint j = i; j < t->n; j += TRANSPOSE_TILE)
+        {
+            const lgint nj = (t->n - j < TRANSPOSE_TILE) ? t->n - j : TRANSPOSE_TILE;
+            char *aij = t->a + i * lda + j * t->size;
+            char *aji = t->a + j * lda + i * t->size;
+
+            // tmp = A_ij^T, A_ij = A_ji^T, A_ji = tmp
+            t->tile(mi, nj, aij, t->lda, tmp, TRANSPOSE_TILE);
+            if (i != j)
+                t->tile(nj, mi, aji, t->lda, aij, t->lda);
+            for (lgint r = 0; r < nj; r++)
+            {
+                memcpy(aji + r * lda, (char *)tmp + r * TRANSPOSE_TILE * t->size, mi * t->size);
+            }
+        }
+    }
+}
+
+static void transpose_square(struct transpose_args *t)
+{
+    if (t->n == 0)
+        return;
+    const lgint n_tiles = (t->n + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    cml_pool_run(n_tiles, 1 + TRANSPOSE_GRAIN / (t->n * TRANSPOSE_TILE), &transpose_square_task, t);
+}
+
+void cml_transpose_square(const lgint n, fdouble *a, const lgint lda)
+{
+    struct transpose_args t = {n, n, (char *)a, lda, (char *)a, lda, sizeof(*a), &transpose_tile_f64};
+    transpose_square(&t);
+}
+
+void cml_transpose_square_f32(const lgint n, float *a, const lgint lda)
+{
+    struct transpose_args t = {n, n, (char *)a, lda, (char *)a, lda, sizeof(*a), &transpose_tile_f32};
+    transpose_square(&t);
+}
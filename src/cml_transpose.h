@@ -0,0 +1,16 @@
+#ifndef cml_transpose_h
+#define cml_transpose_h
+
+#include "cml_matrix.h"
+
+// B(n, m) <= A(m, n)^T out of place, A and B do not overlap
+void cml_transpose(const lgint m, const lgint n, const fdouble *a, const lgint lda, fdouble *b, const lgint ldb);
+
+void cml_transpose_f32(const lgint m, const lgint n, const float *a, const lgint lda, float *b, const lgint ldb);
+
+// A(n, n) <= A^T in place
+void cml_transpose_square(const lgint n, fdouble *a, const lgint lda);
+
+void cml_transpose_square_f32(const lgint n, float *a, const lgint lda);
+
+#endif
@@ -0,0 +1,104 @@
+#include "cml_trsm.h"
+#include "cml_simd.h"
+
+// number of rows solved by substitution before they update the remaining rows
+#define TRSM_BLOCK 256
+
+// number of right-hand sides below which the rows are updated by dot products
+#define TRSM_NARROW 8
+
+// number of right-hand sides solved together, a block of rows of them stays in L2
+#define TRSM_COLS 128
+
+// element (i, j) of op(T)
+static inline fdouble trsm_elem(const fdouble *t, const lgint ldt, const bool trans, const lgint i, const lgint j)
+{
+    return trans ? t[j * ldt + i] : t[i * ldt + j];
+}
+
+// rows [r0, r1) of B <= rows - op(T)[r0:r1, p0:p1]*B[p0:p1]
+static void trsm_update(const fdouble *t, const lgint ldt, const bool trans,
+                        const lgint r0, const lgint r1, const lgint p0, const lgint p1,
+                        const lgint k, fdouble *b, const lgint ldb)
+{
+    if (k < TRSM_NARROW)
+    {
+        // a few right-hand sides: one dot product per element of B, no kernel call
+        for (lgint r = r0; r < r1; r++)
+        {
+            for (lgint c = 0; c < k; c++)
+            {
+                fdouble s = 0.;
+                for (lgint p = p0; p < p1; p++)
+                {
+                    s += trsm_elem(t, ldt, trans, r, p) * b[p * ldb + c];
+                }
+                b[r * ldb + c] -= s;
+            }
+        }
+        return;
+    }
+    for (lgint r = r0; r < r1; r++)
+    {
+        fdouble *br = b + r * ldb;
+        for (lgint p = p0; p < p1; p++)
+        {
+            cml_vec_axpy(k, -trsm_elem(t, ldt, trans, r, p), b + p * ldb, br);
+        }
+    }
+}
+
+// row i of B <= row i / op(T)(i, i)
+static void trsm_scale(const fdouble *t, const lgint ldt, const bool trans, const bool unit,
+                       const lgint i, const lgint k, fdouble *b, const lgint ldb)
+{
+    if (!unit)
+        cml_vec_scale(k, 1. / trsm_elem(t, ldt, trans, i, i), b + i * ldb, b + i * ldb);
+}
+
+// k <= TRSM_COLS right-hand sides
+static void trsm_panel(const bool upper, const bool trans, const bool unit,
+                       const lgint n, const lgint k,
+                       const fdouble *t, const lgint ldt,
+                       fdouble *b, const lgint ldb)
+{
+    if (upper == trans)
+    {
+        // op(T) is lower: forward substitution, each solved block updates the rows below it
+        for (lgint i0 = 0; i0 < n; i0 += TRSM_BLOCK)
+        {
+            const lgint i1 = (n - i0 < TRSM_BLOCK) ? n : i0 + TRSM_BLOCK;
+            for (lgint i = i0; i < i1; i++)
+            {
+                trsm_update(t, ldt, trans, i, i + 1, i0, i, k, b, ldb);
+                trsm_scale(t, ldt, trans, unit, i, k, b, ldb);
+            }
+            trsm_update(t, ldt, trans, i1, n, i0, i1, k, b, ldb);
+        }
+        return;
+    }
+
+    // op(T) is upper: back substitution, each solved block updates the rows above it
+    for (lgint i1 = n; i1 > 0;)
+    {
+        const lgint i0 = (i1 < TRSM_BLOCK) ? 0 : i1 - TRSM_BLOCK;
+        for (lgint i = i1; i > i0; i--)
+        {
+            trsm_update(t, ldt, trans, i - 1, i, i, i1, k, b, ldb);
+            trsm_scale(t, ldt, trans, unit, i - 1, k, b, ldb);
+        }
+        trsm_update(t, ldt, trans, 0, i0, i0, i1, k, b, ldb);
+        i1 = i0;
+    }
+}
+
+void cml_trsm(const bool upper, const bool trans, const bool unit,
+              const lgint n, const lgint k,
+              const fdouble *t, const lgint ldt,
+              fdouble *b, const lgint ldb)
+{
+    for (lgint j = 0; j < k; j += TRSM_COLS)
+    {
+        trsm_panel(upper, trans, unit, n, (k - j < TRSM_COLS) ? k - j : TRSM_COLS, t, ldt, b + j, ldb);
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef cml_trsm_h
+#define cml_trsm_h
+
+#include "cml_matrix.h"
+
+#include <stdbool.h>
+
+// B(n, k) <= op(T)^-1*B in place for the triangular T(n, n), upper or lower
+// as `upper` says, where op(T) is T^T when `trans` is set and T otherwise.
+// The diagonal of T is taken as ones when `unit` is set, the other triangle
+// is never read. Row-major with leading dimensions `ldt` and `ldb`.
+void cml_trsm(const bool upper, const bool trans, const bool unit,
+              const lgint n, const lgint k,
+              const fdouble *t, const lgint ldt,
+              fdouble *b, const lgint ldb);
+
+#endif